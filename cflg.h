@@ -20,10 +20,26 @@
  *   - Automatic --help: Generates usage messages from flag definitions.
  *   - Aggregated short options: Parses -vqc as separate -v -q -c.
  *   - Long option completion: Resolves --he to --help if unambiguous.
+ *   - Flag set layers: Children of a linked flag set accept its flags (e.g. global ones).
+ *   - Negatable booleans: --no-<name> and --<name>=true|false for bool flags.
+ *   - Matching policy: fset.match can make '_' and '-' or letter case equivalent.
  *   - Custom parsers: Handles complex types like --memory=512m.
- *   - Positional rearrangement: Moves non-options first after argv[0].
+ *   - Array flags: --ports=80,443 and --cpus=0-3,8 fill int, int64 or double buffers.
+ *   - Map flags: -e KEY=VAL pairs go into a hash table of slices of argv.
+ *   - Positional rearrangement: Moves non-options first after argv[0], or records
+ *     their indices without touching argv (cflg_flgset_parse_const).
+ *   - POSIX mode: fset.posix stops parsing at the first non-option.
  *   - Duplicate prevention: Tracks parsed flags with has_been_parsed.
+ *   - Conflict detection: Flags sharing a short or long name are reported before parsing.
+ *   - Pull parsing: cflg_next returns flags, values and positionals one event at a time.
+ *   - Command strings: cflg_flgset_parse_line splits a shell-quoted line in place and parses it.
+ *   - Peeking: cflg_flgset_peek reads a few flags (e.g. --config) before the others exist.
+ *   - Parallel lookup: With CFLG_THREADS, long options of huge argv are resolved on threads.
+ *   - Config reloading: With CFLG_WATCH, values in a 'name = value' file follow its edits.
+ *   - Aliases: Flags can have several short and long names, printed on one help line.
  *   - Numeric parsing: Uses strtod and variants for robust integer/float handling.
+ *   - Freestanding builds: With CFLG_FREESTANDING, no stdio or stdlib, output goes to
+ *     CFLG_WRITE and parsing returns an error code instead of exiting.
  *
  * Usage:
  * -------------
@@ -60,6 +76,272 @@
  *     instead of flgset_bool) to avoid naming conflicts with other libraries.
  *     Ideal for large projects or when integrating with conflicting APIs.
  *
+ *   - CFLG_STACK_ARENA_SIZE: Size of the stack buffer which holds the lookup index
+ *     when the flag set has no arena (default: 16384 bytes, enough for ~350 flags).
+ *     Larger flag sets without an arena are still parsed, by scanning their flags.
+ *
+ *   - CFLG_THREADS: Lets cflg_flgset_parse split argv among fset.threads POSIX threads
+ *     which look up the long options in parallel, needs -pthread. Only argument vectors
+ *     of at least CFLG_THREADS_MIN_ARGS (default: 16384) elements are split, and only if
+ *     the arena has 4 * argc bytes to spare, otherwise parsing is serial. Parsers run in
+ *     argv order on the calling thread, so the results are the same as the serial ones.
+ *     See examples/parallel.c.
+ *
+ *   - CFLG_ARRAY_MAX: Most values an arena-backed array flag keeps when its cap is 0
+ *     (default: 65536). Further values, e.g. of a range like 0-4000000000, only set
+ *     overflow.
+ *
+ *   - CFLG_WATCH: Adds cflg_watch_t, which reloads flag values from a config file when it
+ *     changes. Linux only (inotify), uses the GCC/Clang __atomic builtins. See Config
+ *     Reloading below and examples/reload.c.
+ *
+ *   - CFLG_FREESTANDING: Builds without stdio.h and stdlib.h (e.g. firmware with a
+ *     serial console), only string.h and the freestanding headers are used. The
+ *     numbers are read by small replacements of strtoll, strtoull and strtod; doubles
+ *     are exact with up to 15 significant digits and exponents within +-22 and a few
+ *     ulps off beyond that, there are no hex floats, inf or nan. Instead of exiting,
+ *     cflg_flgset_parse returns CFLG_PARSE_FAILED after reporting an error and
+ *     CFLG_PARSE_HELP after printing the help. cflg_out_t is an int, CFLG_STDOUT is 1
+ *     and CFLG_STDERR is 2. Can't be combined with CFLG_WATCH.
+ *
+ *   - CFLG_WRITE(out, buf, len): Writes len bytes of buf to the cflg_out_t out, needed
+ *     by CFLG_FREESTANDING builds unless CFLG_NO_TEXT is defined. Define it before
+ *     including the implementation, e.g. to a UART or semihosting write.
+ *
+ *   - CFLG_NO_TEXT: Leaves out help and error messages, cflg_print_flags and friends
+ *     print nothing. Errors are still detected, which is all a program that only
+ *     checks the result needs, and the formatting code isn't linked.
+ *
+ * Memory
+ * -------------
+ *   cflg never calls malloc. Flags are compound literals owned by the caller and
+ *   everything the library builds itself (e.g. the lookup index) is bump-allocated
+ *   from fset.arena. If no arena is provided, cflg_flgset_parse uses a stack buffer
+ *   of CFLG_STACK_ARENA_SIZE bytes. If the index doesn't fit there, the flags are
+ *   scanned for every option instead, O(f) each, and names defined twice aren't
+ *   reported. For large flag sets, provide the memory yourself:
+ *
+ *   ```c
+ *      static uint64_t mem[4096];
+ *      fset.arena = (cflg_arena_t) {.base = (unsigned char *) mem, .cap = sizeof(mem)};
+ *   ```
+ *
+ *   cflg_flgset_arena_size(&fset) reports exactly how many bytes parsing needs, and an
+ *   optional arena.grow callback can hand out a new block when the current one is full.
+ *
+ * Complexity
+ * -------------
+ *   Parsing untrusted argv is linear in its total length L, whatever it contains, as
+ *   long as the flags are indexed and map flags get tables sized for their keys (see
+ *   below). With f names (long names and aliases), d linked flag sets and parsers that
+ *   are linear in their argument (all built-in ones are):
+ *
+ *   - Indexing the flags: O(f log f) time, O(f) arena memory, once per parse. Without
+ *     an arena and too many flags for the stack buffer there is no index, and every
+ *     option costs O(f * length) instead (see Memory).
+ *   - Short options, grouped or not (-vvv...): O(d) per character, a 256 entry table
+ *     per flag set, so a 1 MB cluster costs 1M table lookups.
+ *   - Long options: O(length) to hash an exact name, plus O(length * log f) to find the
+ *     range of names it is a prefix of; --no-<name> adds one more lookup.
+ *   - Errors: parsing stops at the first one; an ambiguous prefix lists at most
+ *     CFLG_MAX_CANDIDATES (default: 16) names, found by binary search.
+ *   - Positionals: swapped into place, or their indices recorded, O(1) each.
+ *   - Enum values: O(length) for exact choices, plus a scan of the choices for prefixes.
+ *   - Array flags: O(length) per argument, plus the values stored, at most cap (or
+ *     CFLG_ARRAY_MAX if an arena-backed array has cap 0); ranges beyond the room left
+ *     are counted, not expanded, so --xs=0-4000000000 costs its 12 characters once the
+ *     array is full. Arena-backed items at least double when they move, so copying is
+ *     amortised O(1) per value and the dead blocks total less than the live one.
+ *   - Map flags: expected O(length) per pair. Linear probing can degrade to O(size of
+ *     the table) per key for keys crafted to collide, so size tables for the keys you
+ *     expect, not the most argv could hold.
+ *   - --help: sorting the flags is a merge sort, O(f log f) in any order of definition.
+ *
+ *   tests/complexity.c checks these bounds on adversarial argv (with an arena; huge
+ *   ranges included), and tests/fuzz_parse.c is a libFuzzer/AFL harness for the parsers.
+ *
+ * Snapshots
+ * -------------
+ *   A parsed flag set can be saved into a flat buffer and restored in another process
+ *   running the same binary (e.g. workers forked or exec'd by a supervisor), which is
+ *   cheaper than parsing a re-serialised argv again:
+ *
+ *   ```c
+ *      size_t size = cflg_flgset_snapshot(&fset, NULL, 0);  // bytes needed
+ *      void  *blob = malloc(size);
+ *      cflg_flgset_snapshot(&fset, blob, size);
+ *      ...                                               // in the worker, same flags defined
+ *      if (!cflg_flgset_restore(&fset, blob, size)) { ... }  // schema mismatch or corrupt blob
+ *   ```
+ *
+ *   Restoring copies every value in one pass, without looking up flags or calling parsers.
+ *   Strings and positionals point into the blob, so it must stay alive and be aligned like
+ *   a pointer. Array values are copied into the caller's items, or left in the blob for
+ *   arena-backed arrays; map pairs are rehashed into the caller's slots, and restoring
+ *   fails if they don't fit. A lazy flag keeps its argument, and its parser runs again on
+ *   the next cflg_lazy_get. Flags with custom parsers only have their has_seen state
+ *   saved, because the size of their destination is unknown. The blob uses the host's
+ *   byte order and is rejected unless the flags are defined in the same order with the
+ *   same names and types.
+ *
+ * Precompiled Flags
+ * -------------
+ *   tools/cflg_gen.c turns a flag definition file into C source holding a static flag
+ *   table, an index with a minimal perfect hash over the long names and the sorted help
+ *   text as a single string. A flag set that comes with an index (fset.index != NULL)
+ *   is parsed with it as is, so startup does no registration, indexing or sorting.
+ *   See examples/precompiled.c.
+ *
+ *   tools/cflg_bench.c measures what flags cost a program's startup as a whole (spawning
+ *   it until it has exited, and its peak RSS), for the examples and generated programs
+ *   with 1000 and 10000 flags defined in main.
+ *
+ * C++
+ * -------------
+ *   cflg.hpp declares flags as a constexpr schema over the members of a struct, picks
+ *   parsers from the member types and builds the index at compile time. The header
+ *   declarations have C linkage in C++, the implementation is always compiled as C.
+ *   See examples/service.cpp.
+ *
+ * Global Flags
+ * -------------
+ *   Flags shared by every subcommand are defined once in a parent flag set, which each
+ *   subcommand's flag set is linked to:
+ *
+ *   ```c
+ *      cflg_flgset_t global = {.arena = ...}, run = {0};
+ *      flgset_bool(&global, &quiet, 'q', "quiet", "Print nothing");
+ *      flgset_bool(&run, &detach, 'd', "detach", "Run in background");
+ *      if (!cflg_flgset_link(&run, &global)) { ... }  // -d or --detach in global too
+ *      flgset_parse(&run, argc, argv);                 // accepts --quiet and --detach
+ *   ```
+ *
+ *   Linking builds the parent's index once, in the parent's arena, which is therefore
+ *   required, and reports the names both sets define; flags added to the child later are
+ *   checked when it is parsed. Lookups that miss in the child continue in the parent, an
+ *   exact name anywhere wins over prefixes, and prefixes matching flags of both are
+ *   ambiguous. Help lists the parent's flags in their own section. Constraints of the
+ *   parent aren't checked when a child is parsed.
+ *
+ * Compact Flags
+ * -------------
+ *   A cflg_flg_t takes 64 bytes on 64-bit targets. A cflg_compact_t keeps definitions as
+ *   16 byte records whose strings are 32-bit offsets into one pool, where equal strings
+ *   (e.g. argument names) are stored once, and whose parsers are indices into a table:
+ *
+ *   ```c
+ *      static const cflg_parser_t parsers[] = {cflg_parse_bool, cflg_parse_int};
+ *      cflg_compact_t c = {.flgs = recs, .dests = dests, .cap = N, .parsers = parsers,
+ *                          .nparsers = 2, .pool = buf, .pool_cap = sizeof(buf)};
+ *      cflg_compact_add(&c, 1, &count, 'c', "count", "<NUM>", "Number of runs");
+ *      ...
+ *      cflg_flgset_add_compact(&fset, &c);  // right before parsing
+ *   ```
+ *
+ *   The records can also be static const tables. cflg_flgset_add_compact expands every
+ *   record into a 64 byte cflg_flg_t in fset.arena, which only has to live while the flag
+ *   set is in use, and parsing works on those. So while flags are in use, compact ones
+ *   take 80 bytes each plus the pool, more than the 64 of ordinary flags. What they save
+ *   is the time in between: const records and pool can stay in flash, and the arena can
+ *   be reused once the flag set is done, e.g. for one sub-command's table at a time.
+ *   See examples/plugins.c (-DCOMPACT).
+ *
+ * Pull Parsing
+ * -------------
+ *   cflg_next reads argv one event at a time, with the same name lookup as
+ *   cflg_flgset_parse but without binding values, so the caller decides what to do
+ *   with each flag as it arrives and can stop at any point:
+ *
+ *   ```c
+ *      cflg_iter_t  it;
+ *      cflg_event_t ev;
+ *      cflg_iter_init(&it, &fset, argc, argv); // needs fset.arena for the index
+ *      while (cflg_next(&it, &ev)) {
+ *          switch (ev.kind) {
+ *          case CFLG_EVENT_FLAG:       ...     // ev.flg was given
+ *          case CFLG_EVENT_VALUE:      ...     // ev.arg is the argument of ev.flg
+ *          case CFLG_EVENT_POSITIONAL: ...     // ev.arg is a non-flag argument
+ *          case CFLG_EVENT_ERROR:      cflg_iter_print_err(&it, &ev); ...
+ *          }
+ *      }
+ *   ```
+ *
+ *   A flag takes an argument if it has an arg_name. Values and positionals point into argv,
+ *   nothing is copied or rearranged, and '--' and fset.posix end the flags as usual.
+ *
+ * Peeking
+ * -------------
+ *   When some flags decide which others exist (e.g. a config file listing plugins),
+ *   put them into a flag set of their own and peek at argv first:
+ *
+ *   ```c
+ *      static uint64_t early_mem[512];          // keeps the index which link builds
+ *      cflg_flgset_t   early = {.arena = {.base = (unsigned char *) early_mem,
+ *                                         .cap  = sizeof(early_mem)}};
+ *      cflg_flgset_string(&early, &config, 'c', "config", "<FILE>", "Config file");
+ *      cflg_flgset_string(&early, &level, 0, "log-level", "<LEVEL>", "Log level");
+ *      cflg_flgset_peek(&early, argc, argv);    // argv is left as it is
+ *      ... load config, register the plugin flags in fset ...
+ *      if (!cflg_flgset_link(&fset, &early)) { ... }  // --config is valid in the full parse too
+ *      cflg_flgset_parse(&fset, argc, argv);
+ *   ```
+ *
+ *   Peeking alone works without an arena, but a linked flag set needs one, as its index
+ *   outlives the call (see Global Flags). Peek and link each build an index there, so
+ *   twice cflg_flgset_arena_size(&early) is enough for both.
+ *
+ *   Unknown options are skipped without errors, and since peek can't know whether they
+ *   take an argument, so is the rest of a short option group after one (in -vc FILE,
+ *   'c' is skipped unless 'v' is known). A long option may still be abbreviated, by the
+ *   same rules as cflg_flgset_parse, but only among the peeked flags: in the full parse
+ *   the prefix is either resolved to the same flag or reported as ambiguous, unless a
+ *   later flag is named exactly like it. Spell the peeked flags out where that matters.
+ *
+ * Command Strings
+ * -------------
+ *   A command that arrives as one string (e.g. over a control socket) is split in
+ *   place, without allocating, into a caller array of pointers and then parsed like
+ *   argv. Quoting follows the POSIX shell, without expansions:
+ *
+ *   ```c
+ *      char  line[] = "set --rate=5m --verbose \"a b\"";
+ *      char *tokens[64];
+ *      cflg_flgset_parse_line(&fset, line, tokens, 64); // "set" is argv[0]
+ *   ```
+ *
+ *   cflg_flgset_parse_line exits on errors like cflg_flgset_parse does. A server which
+ *   has to survive bad commands splits with cflg_split and reads the words with
+ *   cflg_iter_init/cflg_next instead, using a new flag set for every command.
+ *
+ * Config Reloading
+ * -------------
+ *   With CFLG_WATCH, a long-running program can take flag values from a file of
+ *   'name = value' lines ('#' starts a comment) and pick up edits without restarting:
+ *
+ *   ```c
+ *      static char buf[2 * 65536];                    // two halves, one per generation
+ *      cflg_watch_t w;
+ *      flgset_parse(&fset, argc, argv);                // flags given here keep their value
+ *      if (!cflg_watch_open(&w, &fset, "app.conf", buf, sizeof(buf))) { ... }
+ *      while (running) cflg_watch_poll(&w, 1000);      // watcher thread
+ *      ...
+ *      int level;
+ *      cflg_watch_read(&w, &log_level, &level, sizeof(level));  // any other thread
+ *   ```
+ *
+ *   The watcher builds its own lookup index in fset.arena, which is required here: the
+ *   stack buffer cflg_flgset_parse falls back to is gone once it returns, and without
+ *   room in the arena cflg_watch_open reports how many bytes it needs and fails.
+ *
+ *   Names are looked up like exact long options. Each load goes into the half of buf
+ *   that the previous load didn't use, and only values whose text changed are parsed;
+ *   invalid ones are reported and the old value is kept. The new values are then copied
+ *   to the bound variables under a sequence lock: readers never block the watcher and
+ *   retry while a copy is in progress, so cflg_watch_read never sees half a value.
+ *   Strings point into buf and stay valid until the load after next. Flags with custom
+ *   parsers can't be reloaded, and the file never overrides a flag given on the command
+ *   line. The directory is watched, so editors which replace the file are handled too.
+ *
  * How To Extend
  * -------------
  * cflg is fully extensible for custom data types (e.g., durations like -t 5m or
@@ -151,11 +433,14 @@
  *     - cflg_flg_t: Individual flag definition (name, name_long, parser, dest, usage).
  *     - cflg_parser_context_t: Context passed to custom parsers (opt, arg, dest, state).
  *     - cflg_usage_t: Function pointer for custom help handlers (void (*)(cflg_flgset_t*)).
+ *     - cflg_arena_t: Bump allocator for library memory (base, cap, off, optional grow).
  *
  *   Core Functions and Macros
  *   -------------------------
  *    Default Flag Definition Macros (bind flags to variables):
- *     - cflg_flgset_bool(fset, &var, 'b', "bool", "Usage"): Boolean flag.
+ *     - cflg_flgset_bool(fset, &var, 'b', "bool", "Usage"): Boolean flag. --bool and -b flip var
+ *       once, --bool=true|false sets it and --no-bool clears it (unless a flag named no-bool
+ *       exists). The negated form is resolved by the index, it has no flag or help line.
  *     - cflg_flgset_int(fset, &var, 'i', "int", "<NUM>", "Usage"): Signed int.
  *     - cflg_flgset_int64(fset, &var, 'I', "int64", "<NUM>", "Usage"): 64-bit signed int.
  *     - cflg_flgset_uint(fset, &var, 'u', "uint", "<NUM>", "Usage"): Unsigned int.
@@ -163,13 +448,82 @@
  *     - cflg_flgset_float(fset, &var, 'f', "float", "<VAL>", "Usage"): Float.
  *     - cflg_flgset_double(fset, &var, 'd', "double", "<VAL>", "Usage"): Double.
  *     - cflg_flgset_string(fset, &var, 's', "string", "<STR>", "Usage"): String.
+ *     - cflg_flgset_enum(fset, &var, 'e', "enum", "<VAL>", "Usage", "a", "b", ...): One of fixed
+ *       choices, var (int) receives the index of the choice. Unique prefixes are accepted.
+ *     - cflg_flgset_enum_list(fset, &var, 'e', "enum", "<VAL>", "Usage", choices): Same as above,
+ *       choices is a NULL terminated array.
+ *     - cflg_flgset_int_array(fset, &arr, 'p', "ports", "<LIST>", "Usage"): Delimited ints, arr is
+ *       a cflg_array_t whose items receive the values of every occurrence, count how many and
+ *       overflow whether some didn't fit in cap. Ranges like 0-15 expand to each value. With
+ *       arr.arena set, items are allocated from it instead and grow geometrically, up to cap
+ *       values or CFLG_ARRAY_MAX if cap is 0; pass an arena that outlives the values (not the
+ *       stack fallback of a flag set without one). Running out of it is reported as a memory
+ *       error.
+ *     - cflg_flgset_int64_array, cflg_flgset_double_array: Same with int64_t and double items,
+ *       doubles don't take ranges. The delimiter is arr.delim, ',' by default.
+ *     - cflg_flgset_map(fset, &map, 'e', "env", "<KEY=VAL>", "Usage"): Repeatable KEY=VAL pairs, map
+ *       is a cflg_map_t over a caller's array of zeroed cflg_map_entry_t slots (a power of two,
+ *       at most 3/4 of them are used). Keys and values point into argv, nothing is copied.
+ *       A repeated key replaces the value, or is an invalid argument if map.unique is set.
+ *       cflg_map_get(&map, "KEY") and cflg_map_find(&map, key, len) look keys up afterwards.
  *     - cflg_flgset_func(fset, &var, 'x', "custom", "<ARG>", "Usage", parser_func): Custom parser.
+ *     - cflg_flgset_lazy(fset, &var, 'x', "custom", "<ARG>", "Usage", parser_func): Same, but
+ *       parser_func runs on the first cflg_lazy_get(fset, flg), for expensive parsers.
  *     - cflg_new_flag(fset, parser_func, &var, opt, opt_long, arg, Usage): Low-level flag creation.
+ *     - cflg_flg_alias(flg, 'x', "alias"): Adds another short and/or long name to a flag
+ *       returned by the macros above, e.g. cflg_flg_alias(cflg_flgset_bool(...), 'V', "talkative").
+ *     - cflg_flgset_add(fset, parser_func, &var, opt, opt_long, arg, Usage): Same as cflg_new_flag,
+ *       but the flag lives in fset->arena, so it can be registered from loops and helper functions.
+ *     - cflg_compact_add(c, parser_index, &var, opt, opt_long, arg, Usage): Appends a 16 byte
+ *       record to a compact flag table, cflg_flgset_add_compact(fset, c) registers the table.
+ *     - cflg_flgset_constrain(fset, kind, flg, ...): Constrains a group of flags, kind is one of
+ *       CFLG_REQUIRED, CFLG_EXACTLY_ONE, CFLG_AT_MOST_ONE or CFLG_ALL_OR_NONE.
+ *     - cflg_flgset_requires(fset, flg, other, ...): If flg is used, all the others must be too.
+ *       Constraints are checked once all arguments are parsed; violations are reported together.
  *
  *   Core Functions
  *   --------------
  *     - void cflg_flgset_parse(cflg_flgset_t *fset, int argc, char **argv): Parse arguments.
+ *     - int cflg_flgset_parse_const(cflg_flgset_t *fset, int argc, char *const *argv, int *pos):
+ *       Parse arguments without modifying argv, pos receives the indices of positionals.
+ *     - int cflg_split(char *line, char **tokens, int cap): Split a shell-quoted line in place,
+ *       returns the number of words or CFLG_SPLIT_UNCLOSED / CFLG_SPLIT_FULL.
+ *     - int cflg_flgset_parse_line(cflg_flgset_t *fset, char *line, char **tokens, int cap):
+ *       Split line and parse the words, the first one being the command name.
+ *     - const char *cflg_flgset_arg(cflg_flgset_t *fset, int i): i-th positional argument.
+ *     - bool cflg_flgset_link(cflg_flgset_t *child, cflg_flgset_t *parent): Accept the flags
+ *       of parent in child, false if they share a name or parent's arena is too small.
+ *     - int cflg_flgset_peek(cflg_flgset_t *fset, int argc, char *const *argv): Set the flags
+ *       of fset from argv, ignoring unknown options, returns the number of flags set.
+ *     - void cflg_iter_init(cflg_iter_t *it, cflg_flgset_t *fset, int argc, char *const *argv):
+ *       Start reading argv with cflg_next.
+ *     - bool cflg_next(cflg_iter_t *it, cflg_event_t *ev): Next flag, value, positional or error
+ *       event, false at the end of argv.
  *     - void cflg_print_flags(cflg_flg_t *flags): Print flags with alignment.
+ *     - void cflg_fprint_flags(cflg_out_t out, cflg_flg_t *flags): Same, printing to out.
+ *     - size_t cflg_flgset_arena_size(cflg_flgset_t *fset): Arena bytes needed for parsing.
+ *     - void *cflg_arena_alloc(cflg_arena_t *arena, size_t size): Allocate from an arena.
+ *     - size_t cflg_flgset_snapshot(cflg_flgset_t *fset, void *buf, size_t cap): Save parsed
+ *       values and positionals into buf, returns the size of the snapshot (written if <= cap).
+ *     - bool cflg_flgset_restore(cflg_flgset_t *fset, void *buf, size_t size): Load a snapshot.
+ *     - uint32_t cflg_flgset_schema_hash(cflg_flgset_t *fset): Hash of flag names and types.
+ *     - bool cflg_watch_open(cflg_watch_t *w, cflg_flgset_t *fset, const char *path, char *buf,
+ *       size_t cap): With CFLG_WATCH, load path and start watching it, buf holds two copies.
+ *     - int cflg_watch_poll(cflg_watch_t *w, int timeout_ms): Wait for a change and reload,
+ *       returns the number of values that changed, 0 on timeout and -1 on errors.
+ *     - void cflg_watch_read(cflg_watch_t *w, const void *var, void *out, size_t size): Copy
+ *       a bound variable consistently while the watcher may be writing it.
+ *     - void cflg_watch_close(cflg_watch_t *w): Stop watching.
+ *
+ *   Matching Policies (fset.match, long options only)
+ *   -------------
+ *     - CFLG_MATCH_EXACT: Default, names are compared byte by byte.
+ *     - CFLG_MATCH_SEPARATORS: '_' and '-' are the same, --read_only matches --read-only.
+ *     - CFLG_MATCH_CASE: ASCII letter case is ignored, --Read-Only matches --read-only.
+ *       The policies combine with '|'. Names are folded once when the index is built and
+ *       options while they are hashed, so prefix completion and ambiguity reports use the
+ *       folded names, and names equal under the policy are reported as duplicates.
+ *       Generated indexes (tools/cflg_gen.c) always match exactly.
  *
  * Return Codes (from cflg_parser_t):
  * -------------
@@ -181,14 +535,20 @@
  *     even if `CFLG_OK_NO_ARG` is returned, automatically generates error
  *
  * Dependencies: stdint.h ,stdbool.h, stdio.h, string.h, stdlib.h (for strtod parsing) (C99+).
+ *   CFLG_FREESTANDING builds only need string.h next to the freestanding headers.
  *
  * Notes:
  * -------------
  *   - Positional arguments are rearranged to follow argv[0] in fset.args,
  *     with count in fset.narg. Avoid re-parsing argv after cflg_flgset_parse.
+ *     cflg_flgset_parse_const leaves argv as it is (e.g. to pass it to execv later)
+ *     and writes the indices of the positional arguments to fset.positionals instead;
+ *     cflg_flgset_arg(&fset, i) returns the i-th one in both modes.
  *   - Custom parsers extend via cflg_flgset_func; see examples/ for usage.
  *   - Aggregated short options (-vqc) are split into individual flags.
  *   - Long option completion resolves unambiguous prefixes (e.g., --he for --help).
+ *   - Every short or long name defined by more than one flag is reported when parsing
+ *     starts, and the program exits. The implicit -h/--help gives way to user flags.
  *   - Numeric parsing uses strtod and variants for safe, locale-aware int/float handling.
  *
  *
@@ -206,28 +566,58 @@
 #define CFLG_H_INCLUDE
 
 #include <stdbool.h> // bool
+#include <stddef.h>  // size_t
 #include <stdint.h>  // uint, uint64_t, int32_t, int64_t
 
+#ifdef CFLG_FREESTANDING
+// where help and errors go, the fd passed to CFLG_WRITE
+typedef int cflg_out_t;
+#define CFLG_STDOUT 1
+#define CFLG_STDERR 2
+#else
+#include <stdio.h> // FILE
+typedef FILE *cflg_out_t;
+#define CFLG_STDOUT stdout
+#define CFLG_STDERR stderr
+#endif
+
 #ifndef CFLG_NO_SHORT_NAMES
-#define parser_context_t cflg_parser_context_t
-#define flg_t            cflg_flg_t
-#define flgset_t         cflg_flgset_t
-#define flgset_parse     cflg_flgset_parse
-#define flgset_int       cflg_flgset_int
-#define flgset_uint      cflg_flgset_uint
-#define flgset_int64     cflg_flgset_int64
-#define flgset_uint64    cflg_flgset_uint64
-#define flgset_string    cflg_flgset_string
-#define flgset_bool      cflg_flgset_bool
-#define flgset_float     cflg_flgset_float
-#define flgset_double    cflg_flgset_double
-#define flgset_func      cflg_flgset_func
-#define print_flags      cflg_print_flags
-#define OK               CFLG_OK
-#define OK_NO_ARG        CFLG_OK_NO_ARG
-#define ERR_ARG_NEEDED   CFLG_ERR_ARG_NEEDED
-#define ERR_ARG_INVALID  CFLG_ERR_ARG_INVALID
-#define ERR_ARG_FORCED   CFLG_ERR_ARG_FORCED
+#define parser_context_t    cflg_parser_context_t
+#define flg_t               cflg_flg_t
+#define flgset_t            cflg_flgset_t
+#define flgset_parse        cflg_flgset_parse
+#define flgset_parse_line   cflg_flgset_parse_line
+#define flgset_peek         cflg_flgset_peek
+#define flgset_int          cflg_flgset_int
+#define flgset_uint         cflg_flgset_uint
+#define flgset_int64        cflg_flgset_int64
+#define flgset_uint64       cflg_flgset_uint64
+#define flgset_string       cflg_flgset_string
+#define flgset_bool         cflg_flgset_bool
+#define flgset_float        cflg_flgset_float
+#define flgset_double       cflg_flgset_double
+#define flgset_func         cflg_flgset_func
+#define flgset_lazy         cflg_flgset_lazy
+#define flgset_enum         cflg_flgset_enum
+#define flgset_enum_list    cflg_flgset_enum_list
+#define flgset_int_array    cflg_flgset_int_array
+#define flgset_int64_array  cflg_flgset_int64_array
+#define flgset_double_array cflg_flgset_double_array
+#define flgset_map          cflg_flgset_map
+#define flgset_constrain    cflg_flgset_constrain
+#define flgset_requires     cflg_flgset_requires
+#define flg_alias           cflg_flg_alias
+#define print_flags         cflg_print_flags
+#define OK                  CFLG_OK
+#define OK_NO_ARG           CFLG_OK_NO_ARG
+#define ERR_ARG_NEEDED      CFLG_ERR_ARG_NEEDED
+#define ERR_ARG_INVALID     CFLG_ERR_ARG_INVALID
+#define ERR_ARG_FORCED      CFLG_ERR_ARG_FORCED
+#endif
+
+// the implementation is C, C++ code links against it (see cflg.hpp)
+#ifdef __cplusplus
+extern "C" {
 #endif
 
 // stores the state of each command-line option while parsing
@@ -250,6 +640,10 @@ typedef struct {
     const char *arg; // points to the option's argument
                      // which is always null terminated, NULL if not provided.
 
+    const struct cflg_flg *flg; // the flag being parsed
+
+    bool is_negated; // the option was given as --no-<name> (only for negatable flags)
+
 } cflg_parser_context_t;
 
 /* parser function type
@@ -265,6 +659,26 @@ typedef int (*cflg_parser_t)(cflg_parser_context_t *);
 #define CFLG_ERR_ARG_INVALID -2 /* Parsing failed: option's argument was provided but invalid (e.g., wrong format) */
 #define CFLG_ERR_ARG_FORCED  -3 /* Parsing failed: option's argument was forced but not needed */
 
+/* Errors about the option itself, reported by cflg_next */
+#define CFLG_ERR_OPT_INVALID   -4 /* No flag has this name */
+#define CFLG_ERR_OPT_AMBIGUOUS -5 /* A long option is the prefix of more than one flag's name */
+
+/* Returned by cflg_flgset_parse instead of exiting, only in CFLG_FREESTANDING builds */
+#define CFLG_PARSE_FAILED -1 /* An error was reported, the flag set isn't parsed */
+#define CFLG_PARSE_HELP   -2 /* --help was given and fset->usage has been called */
+
+/* Errors of cflg_split */
+#define CFLG_SPLIT_UNCLOSED -1 /* A quote isn't closed, or the line ends with a backslash */
+#define CFLG_SPLIT_FULL     -2 /* The token buffer is too small */
+
+// an alternative name of a flag, shares the flag's parser, destination and state
+typedef struct cflg_alias cflg_alias_t;
+struct cflg_alias {
+    const char   *name_long; // alternative long option, may be NULL
+    char          name;      // alternative short option, may be 0
+    cflg_alias_t *next;      // points to the next alias of the same flag
+};
+
 typedef struct cflg_flg cflg_flg_t;
 struct cflg_flg {
     cflg_parser_t parser;    // parser binded with this flag
@@ -274,9 +688,90 @@ struct cflg_flg {
     const char   *name_long; // long option (e.g. '--verbose')
     char          name;      // short option (e.g. '-v')
     bool          has_seen;  // reports whether its parser has been called before
+    bool          negatable; // accepts --no-<name>, true by default for cflg_parse_bool flags
+    uint32_t      id;        // position of the flag in the lookup index, assigned when the index is built
+    cflg_alias_t *aliases;   // alternative names of the flag
     cflg_flg_t   *next;      // points to the next flag in the linked-list
 };
 
+typedef struct cflg_arena cflg_arena_t;
+
+/* Function pointer type for growing an arena.
+   Called when an allocation of `size` bytes doesn't fit in the current block.
+   It must point arena->base to a new block of at least `size` bytes (aligned to
+   CFLG_ARENA_ALIGN), set arena->cap and return true, or return false if there is no
+   more memory. Allocations from the old block are still in use, so it must not be
+   freed or moved while the flag set is alive. */
+typedef bool (*cflg_grow_t)(cflg_arena_t *arena, size_t size);
+
+// bump allocator owning every library data structure of a flag set
+struct cflg_arena {
+    unsigned char *base; // current block, NULL if no memory has been provided
+    size_t         cap;  // size of the current block in bytes
+    size_t         off;  // bump offset, next allocation starts at base + off
+    cflg_grow_t    grow; // optional, called when the current block is exhausted
+    void          *user; // opaque pointer for grow's use
+};
+
+// alignment of every arena allocation, arena blocks must be aligned to it as well
+#define CFLG_ARENA_ALIGN 8
+
+// a long name in the lookup index
+typedef struct {
+    const char *name; // long option, not null terminated in general
+    uint32_t    len;  // length of name
+    uint32_t    id;   // id of the flag this name belongs to
+} cflg_name_t;
+
+// read-only lookup structures of a flag set, built once before parsing
+typedef struct cflg_index {
+    cflg_flg_t **flgs;        // flags by id
+    uint32_t     nflgs;       // number of flags
+    cflg_name_t *names;       // long names sorted lexicographically, used for prefix completion
+    uint32_t    *runs;        // runs[i] is the number of id changes in names[0..i],
+                              // a prefix range maps to a single flag if runs is constant on it
+    uint32_t     nnames;      // number of long names
+    uint32_t    *slots;       // open addressing hash table over names (index + 1, 0 if empty)
+    uint32_t     slots_mask;  // number of slots - 1, always a power of two - 1
+    uint32_t     shorts[256]; // short name to id + 1, 0 if not defined
+    uint64_t    *seen;        // bit i is set once the flag with id i has been parsed
+    // set by generated indexes (see tools/cflg_gen.c): slots is a minimal perfect hash of
+    // nnames slots, name n lives in slot hash(n, disp[hash(n, 0) % ndisp]) % nnames
+    const uint32_t *disp;
+    uint32_t        ndisp;
+    // set while parsing with CFLG_THREADS: tokens[i] is the id + 1 of the flag the long
+    // option argv[i] resolved to (with CFLG_TOKEN_NEGATED set for --no-<name>), an error
+    // code if it didn't resolve, or 0 if it isn't one
+    int32_t *tokens;
+    // set if the flag set has a matching policy: names are stored with every byte c
+    // replaced by fold[c], and options are folded the same way when they are looked up
+    const unsigned char *fold;
+    // set instead of the tables above if they don't fit in the stack buffer of a flag set
+    // without an arena (see cflg_flgset_list): lookups scan these flags, like before there
+    // was an index, and only fold and parent are used besides
+    cflg_flg_t *list;
+    // index of the parent flag set, names which aren't found here are looked up there
+    struct cflg_index *parent;
+} cflg_index_t;
+
+// kinds of constraints, checked over the flags of a group when parsing finishes
+#define CFLG_REQUIRED    0 // every flag of the group must be given
+#define CFLG_EXACTLY_ONE 1 // exactly one flag of the group must be given
+#define CFLG_AT_MOST_ONE 2 // the flags of the group are mutually exclusive
+#define CFLG_ALL_OR_NONE 3 // the flags of the group must be given together or not at all
+#define CFLG_REQUIRES    4 // if the trigger flag is given, every flag of the group must be given
+
+typedef struct cflg_constraint cflg_constraint_t;
+struct cflg_constraint {
+    int                kind;    // one of CFLG_REQUIRED, CFLG_EXACTLY_ONE, ...
+    cflg_flg_t        *trigger; // the flag which needs the group, only for CFLG_REQUIRES
+    cflg_flg_t *const *group;   // NULL terminated list of flags
+    uint64_t          *mask;    // group as a bitmask over seen, compiled when the index is built
+    uint32_t           word;    // index of the first word of seen covered by mask
+    uint32_t           nwords;  // number of words in mask
+    cflg_constraint_t *next;    // points to the next constraint of the flag set
+};
+
 typedef struct cflg_flgset cflg_flgset_t;
 
 /* Function pointer type for handling help requests when parsing '-h' or '--help'.
@@ -284,15 +779,81 @@ typedef struct cflg_flgset cflg_flgset_t;
 typedef void (*cflg_usage_t)(cflg_flgset_t *);
 
 struct cflg_flgset {
-    bool         parsed;    // prevents parsing, if true
-    int          narg;      // Number of non-flag arguments in args, including argv[0]
-    char       **args;      // Pointer to argv used for parsing
-    const char  *prog_name; // name of the program
-    cflg_flg_t  *flgs;      // pointer to the head of the flags list
-    cflg_usage_t usage;     // if not specified, falls back to default usage function
-                            // (see cflg_print_help_)
+    bool               parsed;      // prevents parsing, if true
+    int                narg;        // Number of non-flag arguments in args, including argv[0]
+    char             **args;        // Pointer to argv used for parsing
+    const char        *prog_name;   // name of the program
+    cflg_flg_t        *flgs;        // pointer to the head of the flags list
+    cflg_usage_t       usage;       // if not specified, falls back to default usage function
+                                    // (see cflg_print_help_)
+    cflg_arena_t       arena;       // memory for library data structures, if empty a stack buffer
+                                    // of CFLG_STACK_ARENA_SIZE bytes is used while parsing, or
+                                    // no index if it doesn't fit there
+    cflg_index_t      *index;       // lookup index, built from flgs at the start of parsing
+    cflg_constraint_t *constraints; // constraints on flags, checked when parsing finishes
+    int               *positionals; // set by cflg_flgset_parse_const: indices of the non-flag
+                                    // arguments in args, which is left untouched
+    bool               posix;       // stop at the first non-flag argument, like POSIX getopt,
+                                    // the remaining arguments are non-flags
+    int                threads;     // with CFLG_THREADS, number of threads resolving long options
+                                    // of large argument vectors before parsing, 0 or 1 is serial
+    int                match;       // how long options match names, CFLG_MATCH_EXACT by default
+    cflg_flgset_t     *parent;      // set by cflg_flgset_link, its flags are accepted too
+    cflg_index_t      *shared;      // index built by cflg_flgset_link for child flag sets
 };
 
+// matching policies of long options, may be combined (e.g. --Read_Only for --read-only)
+#define CFLG_MATCH_EXACT      0 // names are compared byte by byte
+#define CFLG_MATCH_SEPARATORS 1 // '_' and '-' are the same
+#define CFLG_MATCH_CASE       2 // letter case is ignored (ASCII)
+
+// kinds of events returned by cflg_next
+#define CFLG_EVENT_FLAG       0 // a flag was given, followed by a CFLG_EVENT_VALUE if it takes an argument
+#define CFLG_EVENT_VALUE      1 // the argument of the flag of the previous event
+#define CFLG_EVENT_POSITIONAL 2 // a non-flag argument
+#define CFLG_EVENT_ERROR      3 // err tells what went wrong, e.g. CFLG_ERR_OPT_INVALID
+
+// one step of cflg_next, strings point into argv
+typedef struct {
+    int         kind;         // one of CFLG_EVENT_FLAG, CFLG_EVENT_VALUE, ...
+    int         err;          // error code of CFLG_EVENT_ERROR, CFLG_OK otherwise
+    cflg_flg_t *flg;          // the flag, NULL for positionals and unknown options
+    const char *opt;          // the option as written without dashes, not null terminated
+    uint32_t    opt_len;      // length of opt
+    bool        is_opt_short; // whether opt is a short option (e.g. -v)
+    bool        negated;      // a bool flag given as --no-<name>
+    const char *arg;          // the value or the positional argument, null terminated
+    int         index;        // index of the argv element the event comes from
+} cflg_event_t;
+
+// state of a pull parser over argv, see cflg_iter_init
+typedef struct {
+    cflg_flgset_t *fset;
+    cflg_index_t  *index;
+    int            argc;
+    char *const   *argv;
+    int            curr_index; // argv element being read
+    const char    *shorts;     // rest of a group of short options (e.g. "bc" of -abc)
+    cflg_event_t   value;      // value event of the last flag
+    bool           has_value;  // value is returned by the next call
+    bool           no_flags;   // after '--', or the first positional in POSIX mode
+} cflg_iter_t;
+
+// size of the stack buffer used when a flag set has no arena
+#ifndef CFLG_STACK_ARENA_SIZE
+#define CFLG_STACK_ARENA_SIZE 16384
+#endif
+
+// most options listed when one is ambiguous
+#ifndef CFLG_MAX_CANDIDATES
+#define CFLG_MAX_CANDIDATES 16
+#endif
+
+// most values kept by an arena-backed array flag whose cap is 0
+#ifndef CFLG_ARRAY_MAX
+#define CFLG_ARRAY_MAX 65536
+#endif
+
 #define CFLG_FALLBACK(s, def) ((s) ? (s) : (def))
 
 // cflg_new_flag has been implemented using c99 compound literals
@@ -303,8 +864,89 @@ struct cflg_flgset {
                                      .dest      = (var),                                                               \
                                      .usage     = (desc),                                                              \
                                      .arg_name  = (arg),                                                               \
+                                     .negatable = (parse_function) == cflg_parse_bool,                                 \
                                      .next      = (flgset)->flgs})
 
+// adds an alternative short and/or long name to a flag (e.g. the result of cflg_flgset_bool)
+// and evaluates to the flag, so calls can be nested
+#define cflg_flg_alias(flg, opt, opt_long)                                                                             \
+    cflg_flg_link_alias((flg), &(cflg_alias_t) {.name = (opt), .name_long = (opt_long)})
+
+// destination of an enum flag, maps a fixed set of choices to their index
+typedef struct {
+    int               *dest;     // receives the index of the chosen value in choices
+    const char *const *choices;  // NULL terminated list of valid values
+    uint32_t           nchoices; // number of choices, set when the flag set is indexed
+    uint32_t           seed;     // seed of the perfect hash over choices
+    uint32_t           mask;     // number of table slots - 1
+    uint16_t          *table;    // perfect hash table, choice index + 1 or 0 if empty
+} cflg_enum_t;
+
+// destination of a lazy flag, keeps the argument until the value is first asked for
+typedef struct {
+    void                 *dest;    // passed to parser
+    cflg_parser_t         parser;  // deferred parser, e.g. one that reads a file or resolves a host
+    cflg_parser_context_t ctx;     // context of the last occurrence of the flag, replayed by parser
+    bool                  pending; // the flag was given, but parser hasn't run yet
+} cflg_lazy_t;
+
+// destination of an array flag (e.g. --ports=80,443 --cpus=0-3,8). values of every
+// occurrence are appended to items, integer types accept ranges like 0-15
+typedef struct {
+    void         *items;    // caller's buffer of cap elements, NULL if arena is set
+    uint32_t      cap;      // room in items; with arena, the most values kept (0: CFLG_ARRAY_MAX)
+    uint32_t      count;    // number of values stored
+    bool          overflow; // more values were given than fit, the rest were dropped
+    char          delim;    // separator between values, ',' if 0
+    cflg_arena_t *arena;    // if set, items are allocated from it, e.g. &fset.arena
+    uint32_t      alloc;    // with arena, number of elements allocated for items
+} cflg_array_t;
+
+// a pair of a map flag, both point into the argument: key isn't null terminated,
+// value is (it runs to the end of the argument)
+typedef struct {
+    const char *key;     // NULL if the slot is empty
+    uint32_t    key_len; // length of key
+    const char *value;   // text after the first '=', NULL if the argument has none
+} cflg_map_entry_t;
+
+// destination of a map flag (e.g. -e KEY=VAL), an open addressing hash table over a
+// caller's array of zeroed entries, so lookups after parsing are O(1)
+typedef struct {
+    cflg_map_entry_t *slots;  // mask + 1 entries, filled to at most 3/4
+    uint32_t          mask;   // number of slots - 1, a power of two - 1
+    uint32_t          count;  // number of keys
+    bool              unique; // a repeated key is an error, by default the last value wins
+} cflg_map_t;
+
+// a flag definition in 16 bytes, for large flag sets on targets short of memory.
+// strings are offsets into the pool of a cflg_compact_t, 0 meaning none
+typedef struct {
+    uint32_t name_long; // long option
+    uint32_t arg_name;  // argument's name, 0 if the flag takes no argument
+    uint32_t usage;     // usage message
+    uint16_t parser;    // index into the parser table
+    char     name;      // short option, 0 if none
+} cflg_compact_flg_t;
+
+// flag definitions sharing one string pool, in which equal strings are stored once.
+// every buffer is provided by the caller, flag i binds to dests[i]
+typedef struct {
+    cflg_compact_flg_t  *flgs;       // flag records
+    uint32_t             nflgs;      // number of flags
+    uint32_t             cap;        // room in flgs and dests
+    void               **dests;      // destinations, may be NULL if no flag has one
+    const cflg_parser_t *parsers;    // parser table, e.g. {cflg_parse_bool, cflg_parse_int}
+    uint32_t             nparsers;   // number of parsers
+    char                *pool;       // null terminated strings, pool[0] is the empty string
+    uint32_t             pool_len;   // bytes used in pool
+    uint32_t             pool_cap;   // size of pool
+    uint32_t            *slots;      // optional hash table of pool offsets (0 if empty) for
+                                     // interning, without it equal strings are stored twice
+    uint32_t             slots_mask; // number of slots - 1, a power of two - 1
+    uint32_t             nslots;     // number of used slots, kept at most half of them
+} cflg_compact_t;
+
 #define cflg_flgset_int(flgset, p, name, name_long, arg_name, usage)                                                   \
     cflg_new_flag((flgset), (cflg_parse_int), (int *) (p), (name), (name_long), CFLG_FALLBACK((arg_name), "int"),      \
                   (usage))
@@ -318,11 +960,11 @@ struct cflg_flgset {
 
 #define cflg_flgset_float(flgset, p, name, name_long, arg_name, usage)                                                 \
     cflg_new_flag((flgset), (cflg_parse_float), (float *) (p), (name), (name_long),                                    \
-                  CFLG_FALLBACK((arg_name), "float"), (usage));
+                  CFLG_FALLBACK((arg_name), "float"), (usage))
 
 #define cflg_flgset_uint(flgset, p, name, name_long, arg_name, usage)                                                  \
     cflg_new_flag((flgset), (cflg_parse_uint), (unsigned int *) (p), (name), (name_long),                              \
-                  CFLG_FALLBACK((arg_name), "uint"), (usage));
+                  CFLG_FALLBACK((arg_name), "uint"), (usage))
 
 #define cflg_flgset_int64(flgset, p, name, name_long, arg_name, usage)                                                 \
     cflg_new_flag((flgset), (cflg_parse_int64), (int64_t *) (p), (name), (name_long),                                  \
@@ -334,13 +976,115 @@ struct cflg_flgset {
 
 #define cflg_flgset_double(flgset, p, name, name_long, arg_name, usage)                                                \
     cflg_new_flag((flgset), (cflg_parse_double), (double *) (p), (name), (name_long),                                  \
-                  CFLG_FALLBACK((arg_name), "double"), (usage));
+                  CFLG_FALLBACK((arg_name), "double"), (usage))
+
+// list is a NULL terminated array of valid values,
+// *p is set to the index of the chosen value, unique prefixes are accepted
+#define cflg_flgset_enum_list(flgset, p, name, name_long, arg_name, usage, list)                                      \
+    cflg_new_flag((flgset), (cflg_parse_enum), (&(cflg_enum_t) {.dest = (int *) (p), .choices = (list)}), (name),      \
+                  (name_long), CFLG_FALLBACK((arg_name), "choice"), (usage))
+
+// same as cflg_flgset_enum_list, the remaining arguments are the choices (e.g. "no", "always")
+#define cflg_flgset_enum(flgset, p, name, name_long, arg_name, usage, ...)                                            \
+    cflg_flgset_enum_list((flgset), (p), (name), (name_long), (arg_name), (usage),                                     \
+                          ((const char *const[]) {__VA_ARGS__, NULL}))
+
+// arr points to a cflg_array_t, which receives the int values of a delimited list
+#define cflg_flgset_int_array(flgset, arr, name, name_long, arg_name, usage)                                          \
+    cflg_new_flag((flgset), (cflg_parse_int_array), (cflg_array_t *) (arr), (name), (name_long),                       \
+                  CFLG_FALLBACK((arg_name), "int,..."), (usage))
+
+#define cflg_flgset_int64_array(flgset, arr, name, name_long, arg_name, usage)                                        \
+    cflg_new_flag((flgset), (cflg_parse_int64_array), (cflg_array_t *) (arr), (name), (name_long),                     \
+                  CFLG_FALLBACK((arg_name), "int64,..."), (usage))
+
+// same as cflg_flgset_int_array for doubles, without ranges
+#define cflg_flgset_double_array(flgset, arr, name, name_long, arg_name, usage)                                       \
+    cflg_new_flag((flgset), (cflg_parse_double_array), (cflg_array_t *) (arr), (name), (name_long),                    \
+                  CFLG_FALLBACK((arg_name), "double,..."), (usage))
+
+// map points to a cflg_map_t, which receives the KEY=VAL arguments of every occurrence
+#define cflg_flgset_map(flgset, map, name, name_long, arg_name, usage)                                                \
+    cflg_new_flag((flgset), (cflg_parse_map), (cflg_map_t *) (map), (name), (name_long),                               \
+                  CFLG_FALLBACK((arg_name), "key=value"), (usage))
+
+// adds a constraint of kind (e.g. CFLG_AT_MOST_ONE) over the given flags,
+// which are the results of the flag definition macros
+#define cflg_flgset_constrain(flgset, constraint_kind, ...)                                                            \
+    ((flgset)->constraints = &(cflg_constraint_t) {.kind  = (constraint_kind),                                         \
+                                                   .group = (cflg_flg_t *const[]) {__VA_ARGS__, NULL},                 \
+                                                   .next  = (flgset)->constraints})
+
+// if flg is given, every one of the given flags must be given as well
+#define cflg_flgset_requires(flgset, flg, ...)                                                                         \
+    ((flgset)->constraints = &(cflg_constraint_t) {.kind    = CFLG_REQUIRES,                                           \
+                                                   .trigger = (flg),                                                   \
+                                                   .group   = (cflg_flg_t *const[]) {__VA_ARGS__, NULL},               \
+                                                   .next    = (flgset)->constraints})
 
 #define cflg_flgset_func(flgset, p, name, name_long, arg_name, usage, parser)                                          \
     cflg_new_flag((flgset), (parser), (p), (name), (name_long), (arg_name), (usage))
 
+// same as cflg_flgset_func, but parsing only records the argument, parse_function runs
+// on the first cflg_lazy_get of the flag. lazy flags always take an argument
+#define cflg_flgset_lazy(flgset, p, name, name_long, arg_name, usage, parse_function)                                  \
+    cflg_new_flag((flgset), (cflg_parse_lazy), (&(cflg_lazy_t) {.dest = (p), .parser = (parse_function)}), (name),     \
+                  (name_long), (arg_name), (usage))
+
 int cflg_flgset_parse(cflg_flgset_t *flgset, int argc, char *argv[]);
 
+// same as cflg_flgset_parse, but argv isn't rearranged: the indices of argv[0] and the
+// non-flag arguments are written to positionals (room for argc ints), or to memory from
+// flgset->arena if positionals is NULL. argv[flgset->positionals[i]], i < flgset->narg,
+// are the non-flag arguments
+int cflg_flgset_parse_const(cflg_flgset_t *flgset, int argc, char *const argv[], int *positionals);
+
+// returns the i-th non-flag argument after parsing (0 is argv[0]), in both parse modes
+const char *cflg_flgset_arg(cflg_flgset_t *flgset, int i);
+
+// splits line in place into words like a POSIX shell does without expansions: blanks
+// separate words, '...' is literal, a backslash escapes the next character, and in "..."
+// only \", \\, \$ and \` are escapes. quotes and escapes are removed, each word is
+// terminated in the line. tokens receives a pointer per word and a NULL, cap is its
+// length. returns the number of words, or CFLG_SPLIT_UNCLOSED or CFLG_SPLIT_FULL
+int cflg_split(char *line, char **tokens, int cap);
+
+// splits line with cflg_split and parses the words like cflg_flgset_parse, the first
+// word is the command name (argv[0]). tokens (cap >= 2) becomes flgset->args, so both it
+// and line must outlive the results. errors of the line are reported like flag errors
+int cflg_flgset_parse_line(cflg_flgset_t *flgset, char *line, char **tokens, int cap);
+
+// prepares it to read argv[1..argc) one event at a time with cflg_next. parsers and
+// destinations of the flags are ignored, a flag takes an argument if its arg_name isn't
+// NULL, and there is no implicit --help. the lookup index is built in flgset->arena
+// (there is no stack fallback), errors in the flag definitions are reported like
+// cflg_flgset_parse does, followed by exit(1). argv isn't modified
+void cflg_iter_init(cflg_iter_t *it, cflg_flgset_t *flgset, int argc, char *const argv[]);
+
+// reads the next event into ev, returns false once argv is exhausted. the caller may stop
+// at any time; after an error event, reading continues with the next argv element
+bool cflg_next(cflg_iter_t *it, cflg_event_t *ev);
+
+// prints the message of an error event to stderr like cflg_flgset_parse does
+void cflg_iter_print_err(cflg_iter_t *it, const cflg_event_t *ev);
+
+// sets the flags of flgset from argv and ignores everything else, for the few flags a
+// program needs before it knows the rest (e.g. --config). names are resolved like
+// cflg_flgset_parse does, unknown and ambiguous options are skipped silently, and so is
+// the rest of a short option group after an unknown option, which might take it as its
+// argument. argv and flgset->args aren't touched, there is no --help, and the index
+// lives on the stack if flgset has no arena. returns the number of flags set, or the
+// error (e.g. CFLG_ERR_ARG_INVALID) of the first one that failed, without printing it
+int cflg_flgset_peek(cflg_flgset_t *flgset, int argc, char *const argv[]);
+
+// makes the flags of parent (e.g. global flags) valid in child as well, without copying
+// them: names not found in child are looked up in parent, and in its own parent if it was
+// linked too. the index of parent is built now in parent->arena, so parent can't get more
+// flags afterwards. names of child which parent already has are reported to stderr, in
+// which case false is returned and the sets aren't linked. flags added to child later
+// are checked the same way when child is parsed
+bool cflg_flgset_link(cflg_flgset_t *child, cflg_flgset_t *parent);
+
 // default parser functions
 int cflg_parse_bool(cflg_parser_context_t *ctx);
 int cflg_parse_int(cflg_parser_context_t *ctx);
@@ -350,13 +1094,134 @@ int cflg_parse_uint64(cflg_parser_context_t *ctx);
 int cflg_parse_float(cflg_parser_context_t *ctx);
 int cflg_parse_double(cflg_parser_context_t *ctx);
 int cflg_parse_string(cflg_parser_context_t *ctx);
+int cflg_parse_enum(cflg_parser_context_t *ctx);
+int cflg_parse_lazy(cflg_parser_context_t *ctx);
+int cflg_parse_int_array(cflg_parser_context_t *ctx);
+int cflg_parse_int64_array(cflg_parser_context_t *ctx);
+int cflg_parse_double_array(cflg_parser_context_t *ctx);
+int cflg_parse_map(cflg_parser_context_t *ctx);
+
+// returns the entry of key[0..len) in a map flag's table, or NULL if it wasn't given
+cflg_map_entry_t *cflg_map_find(cflg_map_t *map, const char *key, size_t len);
+
+// returns the value of a null terminated key in a map flag's table, or NULL if it wasn't
+// given (or was given without '=')
+const char *cflg_map_get(cflg_map_t *map, const char *key);
+
+// returns the destination of a lazy flag, running its parser first if the flag was given
+// and this is the first call. parser errors are reported like cflg_flgset_parse does,
+// followed by exit(1)
+void *cflg_lazy_get(cflg_flgset_t *fset, cflg_flg_t *flg);
 
 // expose the defualt print flags function
 void cflg_print_flags(cflg_flg_t *flags);
 
+// same as cflg_print_flags, but prints to out (e.g. to render help ahead of time)
+void cflg_fprint_flags(cflg_out_t out, cflg_flg_t *flags);
+
 // sorts flag list lexicographically and updates the head 
 void cflg_sort_flags(cflg_flg_t **flg_head);
 
+// allocates size bytes aligned to CFLG_ARENA_ALIGN, returns NULL if the arena is exhausted
+void *cflg_arena_alloc(cflg_arena_t *arena, size_t size);
+
+// copies a null terminated string into the arena, returns NULL if the arena is exhausted
+char *cflg_arena_strdup(cflg_arena_t *arena, const char *s);
+
+// registers a flag allocated from the flag set's arena instead of a compound literal,
+// so it stays valid after the calling scope exits (e.g. flags generated in a loop).
+// strings are not copied, use cflg_arena_strdup for temporary ones.
+// returns the new flag or NULL if the arena is exhausted
+cflg_flg_t *cflg_flgset_add(cflg_flgset_t *fset, cflg_parser_t parser, void *dest, char name, const char *name_long,
+                            const char *arg_name, const char *usage);
+
+// appends alias to the aliases of flg and returns flg, used by cflg_flg_alias
+cflg_flg_t *cflg_flg_link_alias(cflg_flg_t *flg, cflg_alias_t *alias);
+
+// same as cflg_flg_alias, but the alias is allocated from the flag set's arena,
+// returns false if the arena is exhausted
+bool cflg_flgset_add_alias(cflg_flgset_t *fset, cflg_flg_t *flg, char name, const char *name_long);
+
+// returns the offset of s in the pool of c, copying it there unless an equal string is
+// already pooled. NULL and "" are offset 0, UINT32_MAX means the pool is full
+uint32_t cflg_compact_intern(cflg_compact_t *c, const char *s);
+
+// appends a flag to c, parser is an index into c->parsers and the strings are interned,
+// so they may be temporary. returns false if c->flgs or the pool is full
+bool cflg_compact_add(cflg_compact_t *c, uint16_t parser, void *dest, char name, const char *name_long,
+                      const char *arg_name, const char *usage);
+
+// registers the flags of c with fset for parsing, expanding each into a cflg_flg_t
+// allocated from fset->arena. strings point into the pool of c, which must outlive the
+// flag set. returns false if the arena is exhausted or a flag refers to a parser
+// outside of the table
+bool cflg_flgset_add_compact(cflg_flgset_t *fset, const cflg_compact_t *c);
+
+// returns the exact number of arena bytes cflg_flgset_parse needs for the flag set
+// (including the implicit --help flag), assuming a block aligned to CFLG_ARENA_ALIGN
+size_t cflg_flgset_arena_size(cflg_flgset_t *fset);
+
+// hash of the names and value types of the flags in definition order, a snapshot
+// can only be restored into a flag set with the same schema hash
+uint32_t cflg_flgset_schema_hash(cflg_flgset_t *fset);
+
+// saves the values bound to the flags, their has_seen state and the positional arguments
+// of a parsed flag set into buf. returns the size of the snapshot, buf is written only
+// if cap is large enough (cflg_flgset_snapshot(fset, NULL, 0) queries the size)
+size_t cflg_flgset_snapshot(cflg_flgset_t *fset, void *buf, size_t cap);
+
+// writes the values saved in a snapshot to the flags' destinations and marks the flag set
+// as parsed. buf must be aligned to CFLG_ARENA_ALIGN and outlive the flag set, strings
+// and positionals point into it. returns false if the schema hash doesn't match or the
+// snapshot is truncated or an array or map flag has less room than the saved values
+// need, in which case some destinations may have been written
+bool cflg_flgset_restore(cflg_flgset_t *fset, void *buf, size_t size);
+
+#ifdef CFLG_WATCH
+
+// reloads values of a flag set from a config file of 'name = value' lines when it changes,
+// see cflg_watch_open. the flags' variables are written under a sequence lock, so threads
+// reading them while a reload is published must go through cflg_watch_read
+typedef struct {
+    cflg_flgset_t *fset;
+    cflg_index_t  *index;   // exact lookup of keys by long name
+    const char    *path;    // the config file
+    const char    *base;    // file name part of path, matched against inotify events
+    int            fd;      // inotify instance, -1 if closed
+    uint32_t       seq;     // sequence lock, odd while values are being written
+    char          *text[2]; // halves of the caller's buffer, holding the last two loads
+    size_t         cap;     // size of each half
+    uint32_t       gen;     // number of loads, text[gen & 1] holds the latest one
+    const char   **prev;    // per flag id: value text in the latest load, NULL if absent
+    uint64_t      *values;  // per flag id: parsed value waiting to be published
+    uint32_t      *changed; // ids of the flags to publish
+} cflg_watch_t;
+
+// loads path into the flags of fset (which must have been parsed already) and starts
+// watching it with inotify. keys are long names without dashes, '#' starts a comment
+// line, and flags given on the command line keep their values. buf holds two copies of
+// the file (strings point into them), fset->arena (required) the lookup index. problems are
+// reported to stderr, returns false if the file can't be loaded or watched
+bool cflg_watch_open(cflg_watch_t *w, cflg_flgset_t *fset, const char *path, char *buf, size_t cap);
+
+// waits up to timeout_ms (-1 forever) for the file to change and reloads it, parsing only
+// the values which differ from the last load. meant to be called in a loop by one thread.
+// returns the number of changed values, or -1 if the file can't be read
+int cflg_watch_poll(cflg_watch_t *w, int timeout_ms);
+
+// copies size bytes of a variable bound to a flag of w into out, never seeing a value
+// which is only partly published. strings stay valid until the second reload after it
+void cflg_watch_read(cflg_watch_t *w, const void *var, void *out, size_t size);
+
+// stops watching, the values stay as they are
+void cflg_watch_close(cflg_watch_t *w);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 //
 // ******                        ******
 // ******                        ******
@@ -377,14 +1242,90 @@ void cflg_sort_flags(cflg_flg_t **flg_head);
 //
 //
 
+#include <limits.h> // INT_MIN, INT_MAX
+#include <string.h> // strlen, strcmp, memcmp
+
+#ifdef CFLG_FREESTANDING
+#include <float.h>  // DBL_MAX
+#include <stdarg.h> // va_list
+
+#if !defined(CFLG_WRITE) && !defined(CFLG_NO_TEXT)
+#error "CFLG_FREESTANDING needs CFLG_WRITE(fd, buf, len) to print help and errors, or CFLG_NO_TEXT"
+#endif
+#ifdef CFLG_WATCH
+#error "CFLG_WATCH needs a hosted build"
+#endif
+
+// set to CFLG_ERANGE by the numeric parsers when a value doesn't fit
+int cflg_errno;
+#define CFLG_ERRNO  cflg_errno
+#define CFLG_ERANGE 34
+
+// the library's own conversions, see the numeric parsers
+long long          cflg_strtoll(const char *s, char **end, int base);
+unsigned long long cflg_strtoull(const char *s, char **end, int base);
+double             cflg_strtod(const char *s, char **end);
+#define cflg_strtol(s, end, base)  cflg_strtoll((s), (end), (base))
+#define cflg_strtoul(s, end, base) cflg_strtoull((s), (end), (base))
+#define cflg_strtof(s, end)        ((float) cflg_strtod((s), (end)))
+#else
+#include <errno.h>  // errno, ERANGE
 #include <stdio.h>  // fprintf
 #include <stdlib.h> // strtod, strtof, ...
-#include <string.h> // strlen, strcmp, memcmp
 
-// invalid option error value
-#define CFLG_ERR_OPT_INVALID -4
-// a long option cannot be auto completed
-#define CFLG_ERR_OPT_AMBIGUOUS -5
+#define CFLG_ERRNO    errno
+#define CFLG_ERANGE   ERANGE
+#define cflg_strtol   strtol
+#define cflg_strtoul  strtoul
+#define cflg_strtoll  strtoll
+#define cflg_strtoull strtoull
+#define cflg_strtof   strtof
+#define cflg_strtod   strtod
+#endif
+
+// every message goes through cflg_fprintf, CFLG_NO_TEXT leaves none of them in the binary
+#ifdef CFLG_NO_TEXT
+static inline int cflg_fprintf(cflg_out_t out, const char *fmt, ...) {
+    (void) out, (void) fmt;
+    return 0;
+}
+#elif defined(CFLG_FREESTANDING)
+int cflg_fprintf(cflg_out_t out, const char *fmt, ...);
+#else
+#define cflg_fprintf fprintf
+#endif
+
+#ifdef CFLG_WATCH
+#include <poll.h>        // poll
+#include <sys/inotify.h> // inotify_init1, inotify_add_watch
+#include <unistd.h>      // read, close
+#endif
+
+#ifdef CFLG_THREADS
+#include <pthread.h>
+
+// argument vectors shorter than this are parsed serially
+#ifndef CFLG_THREADS_MIN_ARGS
+#define CFLG_THREADS_MIN_ARGS 16384
+#endif
+
+// upper bound of fset.threads
+#ifndef CFLG_MAX_THREADS
+#define CFLG_MAX_THREADS 64
+#endif
+#endif
+
+// the arena ran out of memory
+#define CFLG_ERR_NOMEM -6
+// two flags share a name
+#define CFLG_ERR_FLG_DUPLICATE -7
+// a definition refers to a flag which isn't in the flag set
+#define CFLG_ERR_FLG_INVALID -8
+// a constraint isn't satisfied by the parsed flags
+#define CFLG_ERR_CONSTRAINT -9
+
+// polarity bit of index->tokens, set if the option was --no-<name>
+#define CFLG_TOKEN_NEGATED (1 << 30)
 
 // no more argument to parse, returns from cflg_flgset_parse_one in case of finishing parsing
 #define CFLG_PARSE_FINISH 2
@@ -403,14 +1344,37 @@ void cflg_sort_flags(cflg_flg_t **flg_head);
 
 #define CFLG_FOREACH(item, flgs) for (cflg_flg_t *item = (flgs); item != NULL; item = item->next)
 
+#define CFLG_FOREACH_ALIAS(item, flg) for (cflg_alias_t *item = (flg)->aliases; item != NULL; item = item->next)
+
+#define CFLG_ALIGN_UP(n) (((n) + (CFLG_ARENA_ALIGN - 1)) & ~((size_t) CFLG_ARENA_ALIGN - 1))
+
 void cflg_print_err(int err_code, cflg_flgset_t *fs, cflg_parser_context_t *ctx);
+cflg_map_entry_t *cflg_map_slot(cflg_map_t *map, const char *key, uint32_t len);
 
 // default print usage function
 // prints usage string and all flag names (short and long)
 void cflg_print_help_(cflg_flgset_t *fset) {
-    printf("Usage: %s [OPTION]... [COMMAND]...\n\n", fset->prog_name);
+#ifdef CFLG_NO_TEXT
+    (void) fset;
+#else
+    cflg_fprintf(CFLG_STDOUT, "Usage: %s [OPTION]... [COMMAND]...\n\n", fset->prog_name);
     cflg_sort_flags(&fset->flgs);
     cflg_print_flags(fset->flgs);
+
+    // flags of linked parents, one section each
+    for (cflg_flgset_t *p = fset->parent; p != NULL; p = p->parent) {
+        if (p->flgs == NULL) {
+            continue;
+        }
+        if (p->prog_name) {
+            cflg_fprintf(CFLG_STDOUT, "\nOptions of %s:\n\n", p->prog_name);
+        } else {
+            cflg_fprintf(CFLG_STDOUT, "\nGlobal options:\n\n");
+        }
+        cflg_sort_flags(&p->flgs);
+        cflg_print_flags(p->flgs);
+    }
+#endif
 }
 
 const char *cflg_find_base(const char *path) {
@@ -422,126 +1386,974 @@ const char *cflg_find_base(const char *path) {
     return path;
 }
 
-int cflg_flg_find_long(cflg_flg_t *flgs, const char *opt, uint32_t opt_len, cflg_flg_t **res) {
-    *res           = NULL;
-    bool ambiguous = false;
+void *cflg_arena_alloc(cflg_arena_t *arena, size_t size) {
+    size = CFLG_ALIGN_UP(size);
 
-    CFLG_FOREACH(i, flgs) {
-        if (!CFLG_STRNCMP(i->name_long, opt, opt_len)) {
-            size_t name_len = CFLG_STRLEN(i->name_long);
-
-            // if it's an exact match
-            if (opt_len == name_len) {
-                *res = i;
-                return CFLG_OK;
-            }
-            // if it's a partial match
-            if (opt_len < name_len) {
-                // if there were other partial matches before
-                if (*res) {
-                    //  if an exact match not found later, returns an error
-                    ambiguous = true;
-                }
-                *res = i;
-            }
+    size_t off = CFLG_ALIGN_UP((uintptr_t) arena->base + arena->off) - (uintptr_t) arena->base;
+    if (arena->base == NULL || off > arena->cap || size > arena->cap - off) {
+        if (arena->grow == NULL || !arena->grow(arena, size)) {
+            return NULL;
+        }
+        arena->off = 0;
+        off        = CFLG_ALIGN_UP((uintptr_t) arena->base) - (uintptr_t) arena->base;
+        if (arena->base == NULL || off > arena->cap || size > arena->cap - off) {
+            return NULL;
         }
     }
 
-    if (ambiguous) {
-        return CFLG_ERR_OPT_AMBIGUOUS;
+    arena->off = off + size;
+    return arena->base + off;
+}
+
+char *cflg_arena_strdup(cflg_arena_t *arena, const char *s) {
+    size_t len = strlen(s) + 1;
+    char  *dup = cflg_arena_alloc(arena, len);
+    if (dup) {
+        memcpy(dup, s, len);
     }
+    return dup;
+}
 
-    if (*res) {
-        return CFLG_OK;
+cflg_flg_t *cflg_flgset_add(cflg_flgset_t *fset, cflg_parser_t parser, void *dest, char name, const char *name_long,
+                            const char *arg_name, const char *usage) {
+    cflg_flg_t *f = cflg_arena_alloc(&fset->arena, sizeof(cflg_flg_t));
+    if (f == NULL) {
+        return NULL;
     }
+    *f = (cflg_flg_t) {.name      = name,
+                       .name_long = name_long,
+                       .parser    = parser,
+                       .dest      = dest,
+                       .usage     = usage,
+                       .arg_name  = arg_name,
+                       .negatable = parser == cflg_parse_bool,
+                       .next      = fset->flgs};
+    return fset->flgs = f;
+}
 
-    return CFLG_ERR_OPT_INVALID;
+cflg_flg_t *cflg_flg_link_alias(cflg_flg_t *flg, cflg_alias_t *alias) {
+    // appends, so aliases are printed in the order they were defined
+    cflg_alias_t **tail = &flg->aliases;
+    while (*tail) {
+        tail = &(*tail)->next;
+    }
+    alias->next = NULL;
+    *tail       = alias;
+    return flg;
 }
 
-void cflg_swap_args(char *argv[], int i, int j) {
-    if (i != j) {
-        char *tmp = argv[i];
-        argv[i]   = argv[j];
-        argv[j]   = tmp;
+bool cflg_flgset_add_alias(cflg_flgset_t *fset, cflg_flg_t *flg, char name, const char *name_long) {
+    cflg_alias_t *a = cflg_arena_alloc(&fset->arena, sizeof(cflg_alias_t));
+    if (a == NULL) {
+        return false;
     }
+    *a = (cflg_alias_t) {.name = name, .name_long = name_long};
+    cflg_flg_link_alias(flg, a);
+    return true;
 }
 
-int cflg_flgset_parse_one_long(cflg_flgset_t *fs, int argc, char *argv[], cflg_parser_context_t *ctx, int *curr_index) {
+// FNV-1a seeded through its offset basis, with a final mix so the low bits used
+// for slots depend on every byte and on the seed
+uint32_t cflg_hash(const char *s, uint32_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (uint32_t i = 0; i < len; ++i) {
+        h ^= (unsigned char) s[i];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
 
-    // search for '=' in flag
-    ctx->arg = strchr(ctx->opt, '=');
-    // if there is '=' (e.g. --count=3)
-    if (ctx->arg) {
-        ctx->is_arg_forced = true;
-        ctx->opt_len       = ctx->arg - ctx->opt;
-        ctx->arg++;
+uint32_t cflg_compact_intern(cflg_compact_t *c, const char *s) {
+    if (CFLG_ISEMPTY(s)) {
+        return 0;
     }
-    // if there is NOT '=' (e.g. --count 3)
-    else {
-        ctx->is_arg_forced = false;
-        ctx->opt_len       = CFLG_STRLEN(ctx->opt);
-        ctx->arg           = argv[*curr_index + 1];
+    if (c->pool_len == 0) {
+        if (c->pool_cap == 0) {
+            return UINT32_MAX;
+        }
+        c->pool[0]  = '\0';
+        c->pool_len = 1;
     }
 
-    cflg_flg_t *f   = NULL;
-    int         res = cflg_flg_find_long(fs->flgs, ctx->opt, ctx->opt_len, &f);
-    if (res != CFLG_OK) {
-        return res;
+    uint32_t  len  = strlen(s);
+    uint32_t *slot = NULL;
+    if (c->slots != NULL) {
+        for (uint32_t i = cflg_hash(s, len, 0);; ++i) {
+            slot = &c->slots[i & c->slots_mask];
+            if (*slot == 0) {
+                break;
+            }
+            if (!memcmp(c->pool + *slot, s, len + 1)) {
+                return *slot;
+            }
+        }
     }
 
-    // if ctx->arg is an empty string (e.g. --count=)
-    if (CFLG_ISEMPTY(ctx->arg)) {
-        ctx->arg = NULL;
+    if (c->pool_cap - c->pool_len < len + 1) {
+        return UINT32_MAX;
     }
-    ctx->has_been_parsed = f->has_seen;
-    ctx->dest            = f->dest;
+    uint32_t off = c->pool_len;
+    memcpy(c->pool + off, s, len + 1);
+    c->pool_len += len + 1;
+
+    // once the table is half full, new strings are no longer interned
+    if (slot != NULL && (c->nslots + 1) * 2 <= c->slots_mask + 1) {
+        *slot = off;
+        c->nslots++;
+    }
+    return off;
+}
 
-    res = f->parser(ctx);
+bool cflg_compact_add(cflg_compact_t *c, uint16_t parser, void *dest, char name, const char *name_long,
+                      const char *arg_name, const char *usage) {
+    if (c->nflgs == c->cap) {
+        return false;
+    }
+    cflg_compact_flg_t f = {.name_long = cflg_compact_intern(c, name_long),
+                            .arg_name  = cflg_compact_intern(c, arg_name),
+                            .usage     = cflg_compact_intern(c, usage),
+                            .parser    = parser,
+                            .name      = name};
+    if (f.name_long == UINT32_MAX || f.arg_name == UINT32_MAX || f.usage == UINT32_MAX) {
+        return false;
+    }
+    if (c->dests != NULL) {
+        c->dests[c->nflgs] = dest;
+    }
+    c->flgs[c->nflgs++] = f;
+    return true;
+}
 
-    if (res == CFLG_OK_NO_ARG) {
-        if (ctx->is_arg_forced) {
-            return CFLG_ERR_ARG_FORCED;
+#define CFLG_POOL_STR(c, off) ((off) ? (c)->pool + (off) : NULL)
+
+bool cflg_flgset_add_compact(cflg_flgset_t *fset, const cflg_compact_t *c) {
+    for (uint32_t i = 0; i < c->nflgs; ++i) {
+        const cflg_compact_flg_t *f = &c->flgs[i];
+        if (f->parser >= c->nparsers) {
+            return false;
         }
-        ctx->opt = NULL;
-    } else {
-        // if it's CFLG_OK, CFLG_ERR_ARG_NEEDED, CFLG_ERR_ARG_INVALID or CFLG_ERR_ARG_FORCED
-        if (res == CFLG_OK) {
-            ctx->opt = NULL;
+        if (cflg_flgset_add(fset, c->parsers[f->parser], c->dests ? c->dests[i] : NULL, f->name,
+                            CFLG_POOL_STR(c, f->name_long), CFLG_POOL_STR(c, f->arg_name),
+                            CFLG_POOL_STR(c, f->usage)) == NULL) {
+            return false;
         }
-        if (!ctx->is_arg_forced) {
-            ++(*curr_index);
+    }
+    return true;
+}
+
+// number of hash slots for n names, a power of two with load factor <= 0.5
+uint32_t cflg_index_nslots(uint32_t nnames) {
+    uint32_t n = 2;
+    while (n < 2 * nnames) {
+        n <<= 1;
+    }
+    return n;
+}
+
+// bytes needed by an index of nflgs flags and nnames long names,
+// must mirror the allocations of cflg_flgset_index
+size_t cflg_index_size(uint32_t nflgs, uint32_t nnames) {
+    return CFLG_ALIGN_UP(sizeof(cflg_index_t)) + CFLG_ALIGN_UP(nflgs * sizeof(cflg_flg_t *)) +
+           CFLG_ALIGN_UP(nnames * sizeof(cflg_name_t)) + CFLG_ALIGN_UP(nnames * sizeof(uint32_t)) +
+           CFLG_ALIGN_UP(cflg_index_nslots(nnames) * sizeof(uint32_t)) +
+           CFLG_ALIGN_UP((nflgs + 63) / 64 * sizeof(uint64_t));
+}
+
+// counts the flags and long names of a flag set
+void cflg_flgset_count(cflg_flgset_t *fs, uint32_t *nflgs, uint32_t *nnames) {
+    *nflgs = *nnames = 0;
+    CFLG_FOREACH(f, fs->flgs) {
+        (*nflgs)++;
+        if (!CFLG_ISEMPTY(f->name_long)) {
+            (*nnames)++;
+        }
+        CFLG_FOREACH_ALIAS(a, f) {
+            if (!CFLG_ISEMPTY(a->name_long)) {
+                (*nnames)++;
+            }
         }
     }
+}
 
-    f->has_seen = true;
+// number of slots of an enum's perfect hash table with n choices, sparse enough
+// (about n^2/4, between 2n and 16n) that a collision free seed is found in a few tries
+uint32_t cflg_enum_nslots(uint32_t n) {
+    uint32_t want = n * n / 4;
+    if (want > 16 * n) {
+        want = 16 * n;
+    }
+    if (want < 2 * n) {
+        want = 2 * n;
+    }
+    uint32_t nslots = 2;
+    while (nslots < want) {
+        nslots <<= 1;
+    }
+    return nslots;
+}
 
-    return res;
+// number of choices of an enum flag
+uint32_t cflg_enum_count(cflg_enum_t *e) {
+    uint32_t n = 0;
+    while (e->choices[n]) {
+        n++;
+    }
+    return n;
 }
 
-int cflg_flgset_parse_one(cflg_flgset_t *fs, int argc, char *argv[], cflg_parser_context_t *ctx, int *curr_index) {
+// id the index will give f, first being the id of fs->flgs
+uint32_t cflg_flgset_future_id(cflg_flgset_t *fs, const cflg_flg_t *f, uint32_t first) {
+    uint32_t id = first;
+    for (cflg_flg_t *g = fs->flgs; g != NULL && g != f; g = g->next) {
+        id++;
+    }
+    return id;
+}
 
-    if (fs->parsed) {
-        return CFLG_PARSE_FINISH;
+// finds the words of seen covered by the flags of a constraint. with fs, the ids are
+// counted as the index would assign them (see cflg_flgset_future_id), without it the
+// ids assigned by the index are used
+void cflg_constraint_span(cflg_constraint_t *c, cflg_flgset_t *fs, uint32_t first, uint32_t *word,
+                          uint32_t *nwords) {
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (cflg_flg_t *const *g = c->group; *g; ++g) {
+        uint32_t id = fs ? cflg_flgset_future_id(fs, *g, first) : (*g)->id;
+        lo          = id / 64 < lo ? id / 64 : lo;
+        hi          = id / 64 > hi ? id / 64 : hi;
     }
+    *word   = lo == UINT32_MAX ? 0 : lo;
+    *nwords = lo == UINT32_MAX ? 0 : hi - lo + 1;
+}
 
-    // Advance to the next argv element
-    if (CFLG_ISEMPTY(ctx->opt)) {
+// arena bytes needed to index the flag set, with one more flag named --help if help is true
+size_t cflg_flgset_size(cflg_flgset_t *fs, bool help) {
+    uint32_t nflgs, nnames;
+    cflg_flgset_count(fs, &nflgs, &nnames);
+    size_t size = cflg_index_size(nflgs + help, nnames + help);
 
-        ++(*curr_index);
-        if (*curr_index == argc) {
-            fs->parsed = true;
-            return CFLG_PARSE_FINISH;
+    CFLG_FOREACH(f, fs->flgs) {
+        if (f->parser == cflg_parse_enum) {
+            size += CFLG_ALIGN_UP(cflg_enum_nslots(cflg_enum_count(f->dest)) * sizeof(uint16_t));
         }
+    }
+    for (cflg_constraint_t *c = fs->constraints; c != NULL; c = c->next) {
+        uint32_t word, nwords;
+        // masks depend on the ids, which are only assigned by the index
+        cflg_constraint_span(c, fs, help, &word, &nwords);
+        size += CFLG_ALIGN_UP(nwords * sizeof(uint64_t));
+    }
 
-        const char *curr_arg = argv[*curr_index];
-        if (CFLG_IS_NONFLG(curr_arg)) {
-            return CFLG_PARSE_NONFLG;
+    // the fold table and the folded copies of the names
+    if (fs->match != CFLG_MATCH_EXACT) {
+        size += CFLG_ALIGN_UP(256) + (help ? CFLG_ALIGN_UP(strlen("help")) : 0);
+        CFLG_FOREACH(f, fs->flgs) {
+            size += CFLG_ALIGN_UP(CFLG_STRLEN(f->name_long));
+            CFLG_FOREACH_ALIAS(a, f) {
+                size += CFLG_ALIGN_UP(CFLG_STRLEN(a->name_long));
+            }
         }
+    }
+    return size;
+}
 
-        // get rid of the '-'
-        ctx->opt = curr_arg + 1;
+size_t cflg_flgset_arena_size(cflg_flgset_t *fset) {
+    return cflg_flgset_size(fset, true);
+}
 
-        // if it startes with '--'
+// compares two names lexicographically, shorter one is smaller on equal prefixes
+int cflg_cmp_names(const cflg_name_t *a, const cflg_name_t *b) {
+    int diff = memcmp(a->name, b->name, a->len < b->len ? a->len : b->len);
+    if (diff != 0) {
+        return diff;
+    }
+    return (a->len > b->len) - (a->len < b->len);
+}
+
+// same as memcmp, but with b folded first if fold isn't NULL
+int cflg_memcmp_fold(const char *a, const char *b, uint32_t len, const unsigned char *fold) {
+    if (fold == NULL) {
+        return memcmp(a, b, len);
+    }
+    for (uint32_t i = 0; i < len; ++i) {
+        int diff = (unsigned char) a[i] - fold[(unsigned char) b[i]];
+        if (diff != 0) {
+            return diff;
+        }
+    }
+    return 0;
+}
+
+// the long name of an index entry as the flag or alias defined it, entries of a folding
+// index only hold the folded copy
+const char *cflg_index_spelling(const cflg_index_t *idx, const cflg_name_t *n) {
+    const cflg_flg_t *f = idx->flgs[n->id];
+    if (idx->fold == NULL || f == NULL) {
+        return n->name;
+    }
+    if (CFLG_STRLEN(f->name_long) == n->len && !cflg_memcmp_fold(n->name, f->name_long, n->len, idx->fold)) {
+        return f->name_long;
+    }
+    CFLG_FOREACH_ALIAS(a, f) {
+        if (CFLG_STRLEN(a->name_long) == n->len && !cflg_memcmp_fold(n->name, a->name_long, n->len, idx->fold)) {
+            return a->name_long;
+        }
+    }
+    return n->name;
+}
+
+// same as cflg_hash, but with every byte folded first if fold isn't NULL
+uint32_t cflg_hash_fold(const char *s, uint32_t len, uint32_t seed, const unsigned char *fold) {
+    if (fold == NULL) {
+        return cflg_hash(s, len, seed);
+    }
+    uint32_t h = 2166136261u ^ seed;
+    for (uint32_t i = 0; i < len; ++i) {
+        h ^= fold[(unsigned char) s[i]];
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// compares a name with the prefix opt[0..len), folded by fold if it isn't NULL
+// returns 0 if name starts with opt, otherwise same as cflg_cmp_names
+int cflg_cmp_prefix(const cflg_name_t *name, const char *opt, uint32_t len, const unsigned char *fold) {
+    int diff = cflg_memcmp_fold(name->name, opt, name->len < len ? name->len : len, fold);
+    if (diff != 0) {
+        return diff;
+    }
+    return name->len < len ? -1 : 0;
+}
+
+void cflg_sift_names(cflg_name_t *names, uint32_t root, uint32_t n) {
+    for (;;) {
+        uint32_t child = 2 * root + 1;
+        if (child >= n) {
+            return;
+        }
+        if (child + 1 < n && cflg_cmp_names(&names[child], &names[child + 1]) < 0) {
+            child++;
+        }
+        if (cflg_cmp_names(&names[root], &names[child]) >= 0) {
+            return;
+        }
+        cflg_name_t tmp = names[root];
+        names[root]     = names[child];
+        names[child]    = tmp;
+        root            = child;
+    }
+}
+
+// sorts names in place using heap sort, O(n log n) with no extra memory
+void cflg_sort_names(cflg_name_t *names, uint32_t n) {
+    for (uint32_t i = n / 2; i-- > 0;) {
+        cflg_sift_names(names, i, n);
+    }
+    for (uint32_t end = n; end-- > 1;) {
+        cflg_name_t tmp = names[0];
+        names[0]        = names[end];
+        names[end]      = tmp;
+        cflg_sift_names(names, 0, end);
+    }
+}
+
+// returns the hash slot holding name[0..len), or the empty slot where it would be inserted.
+// name is folded on the fly, folding the stored (already folded) names again changes nothing
+uint32_t *cflg_index_slot(cflg_index_t *idx, const char *name, uint32_t len) {
+    uint32_t slot = cflg_hash_fold(name, len, 0, idx->fold) & idx->slots_mask;
+    while (idx->slots[slot]) {
+        cflg_name_t *other = &idx->names[idx->slots[slot] - 1];
+        if (other->len == len && !cflg_memcmp_fold(other->name, name, len, idx->fold)) {
+            break;
+        }
+        slot = (slot + 1) & idx->slots_mask;
+    }
+    return &idx->slots[slot];
+}
+
+// adds a short and a long name of flag f to the index, reports them if they are already taken
+// returns CFLG_ERR_FLG_DUPLICATE on conflicts, a weak flag skips taken names silently
+int cflg_index_add(cflg_flgset_t *fs, cflg_index_t *idx, cflg_flg_t *f, char name, const char *name_long, bool weak) {
+    int res = CFLG_OK;
+
+    unsigned char c = (unsigned char) name;
+    if (c && !idx->shorts[c]) {
+        idx->shorts[c] = f->id + 1;
+    } else if (c && !weak) {
+        cflg_fprintf(CFLG_STDERR, "%s: flag '-%c' is defined more than once\n", CFLG_FALLBACK(fs->prog_name, "cflg"),
+                     c);
+        res = CFLG_ERR_FLG_DUPLICATE;
+    }
+
+    if (CFLG_ISEMPTY(name_long)) {
+        return res;
+    }
+    uint32_t    len    = strlen(name_long);
+    const char *stored = name_long;
+    // names are folded once here, so sorting and prefix search work on folded names
+    if (idx->fold != NULL) {
+        char *folded = cflg_arena_alloc(&fs->arena, len);
+        if (folded == NULL) {
+            return CFLG_ERR_NOMEM;
+        }
+        for (uint32_t i = 0; i < len; ++i) {
+            folded[i] = (char) idx->fold[(unsigned char) name_long[i]];
+        }
+        stored = folded;
+    }
+    idx->names[idx->nnames] = (cflg_name_t) {.name = stored, .len = len, .id = f->id};
+    uint32_t *slot          = cflg_index_slot(idx, stored, len);
+    if (!*slot) {
+        *slot = ++idx->nnames;
+    } else if (!weak) {
+        cflg_fprintf(CFLG_STDERR, "%s: flag '--%s' is defined more than once\n", CFLG_FALLBACK(fs->prog_name, "cflg"),
+                name_long);
+        res = CFLG_ERR_FLG_DUPLICATE;
+    }
+    return res;
+}
+
+// builds the perfect hash table of an enum flag by trying seeds until no two choices collide
+int cflg_enum_build(cflg_flgset_t *fs, cflg_flg_t *f) {
+    cflg_enum_t *e      = f->dest;
+    uint32_t     n      = cflg_enum_count(e);
+    uint32_t     nslots = cflg_enum_nslots(n);
+
+    e->table = cflg_arena_alloc(&fs->arena, nslots * sizeof(uint16_t));
+    if (e->table == NULL) {
+        return CFLG_ERR_NOMEM;
+    }
+    e->nchoices = n;
+    e->mask     = nslots - 1;
+
+    for (uint32_t seed = 0; seed < 4096; ++seed) {
+        memset(e->table, 0, nslots * sizeof(uint16_t));
+        uint32_t  i;
+        uint16_t *slot = NULL;
+        for (i = 0; i < n; ++i) {
+            slot = &e->table[cflg_hash(e->choices[i], strlen(e->choices[i]), seed) & e->mask];
+            if (*slot) {
+                break;
+            }
+            *slot = i + 1;
+        }
+        if (i == n) {
+            e->seed = seed;
+            return CFLG_OK;
+        }
+        // equal choices collide whatever the seed is
+        if (!strcmp(e->choices[*slot - 1], e->choices[i])) {
+            cflg_fprintf(CFLG_STDERR, "%s: choice '%s' of flag '--%s' is defined more than once\n", fs->prog_name,
+                    e->choices[i], CFLG_FALLBACK(f->name_long, ""));
+            return CFLG_ERR_FLG_DUPLICATE;
+        }
+    }
+
+    // practically unreachable, lookups fall back to scanning the choices
+    e->table = NULL;
+    return CFLG_OK;
+}
+
+// compiles the group of a constraint to a bitmask over the seen words it covers
+int cflg_constraint_build(cflg_flgset_t *fs, cflg_index_t *idx, cflg_constraint_t *c) {
+    for (cflg_flg_t *const *g = c->group; *g; ++g) {
+        if ((*g)->id >= idx->nflgs || idx->flgs[(*g)->id] != *g) {
+            cflg_fprintf(CFLG_STDERR, "%s: constraint refers to a flag which is not in the flag set\n", fs->prog_name);
+            return CFLG_ERR_FLG_INVALID;
+        }
+    }
+    if (c->kind == CFLG_REQUIRES &&
+        (c->trigger == NULL || c->trigger->id >= idx->nflgs || idx->flgs[c->trigger->id] != c->trigger)) {
+        cflg_fprintf(CFLG_STDERR, "%s: constraint refers to a flag which is not in the flag set\n", fs->prog_name);
+        return CFLG_ERR_FLG_INVALID;
+    }
+
+    cflg_constraint_span(c, NULL, 0, &c->word, &c->nwords);
+    c->mask = cflg_arena_alloc(&fs->arena, c->nwords * sizeof(uint64_t));
+    if (c->mask == NULL && c->nwords) {
+        return CFLG_ERR_NOMEM;
+    }
+    memset(c->mask, 0, c->nwords * sizeof(uint64_t));
+    for (cflg_flg_t *const *g = c->group; *g; ++g) {
+        c->mask[(*g)->id / 64 - c->word] |= (uint64_t) 1 << ((*g)->id % 64);
+    }
+    return CFLG_OK;
+}
+
+// folding table of the matching policy of fs, allocated in its arena
+unsigned char *cflg_fold_table(cflg_flgset_t *fs) {
+    unsigned char *fold = cflg_arena_alloc(&fs->arena, 256);
+    if (fold == NULL) {
+        return NULL;
+    }
+    for (int c = 0; c < 256; ++c) {
+        fold[c] = (unsigned char) c;
+    }
+    if (fs->match & CFLG_MATCH_SEPARATORS) {
+        fold['_'] = '-';
+    }
+    if (fs->match & CFLG_MATCH_CASE) {
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            fold[c] = (unsigned char) (c - 'A' + 'a');
+        }
+    }
+    return fold;
+}
+
+// builds the lookup index of the flag set in its arena, ids are assigned in list order.
+// every name defined by more than one flag is reported, except the names of `weak`
+// (the implicit help flag) which silently give way to the other flags.
+int cflg_flgset_index(cflg_flgset_t *fs, cflg_flg_t *weak) {
+    uint32_t nflgs, nnames;
+    cflg_flgset_count(fs, &nflgs, &nnames);
+    uint32_t nslots = cflg_index_nslots(nnames);
+
+    cflg_index_t *idx = cflg_arena_alloc(&fs->arena, sizeof(cflg_index_t));
+    if (idx == NULL) {
+        return CFLG_ERR_NOMEM;
+    }
+    idx->flgs  = cflg_arena_alloc(&fs->arena, nflgs * sizeof(cflg_flg_t *));
+    idx->names = cflg_arena_alloc(&fs->arena, nnames * sizeof(cflg_name_t));
+    idx->runs  = cflg_arena_alloc(&fs->arena, nnames * sizeof(uint32_t));
+    idx->slots = cflg_arena_alloc(&fs->arena, nslots * sizeof(uint32_t));
+    idx->seen  = cflg_arena_alloc(&fs->arena, (nflgs + 63) / 64 * sizeof(uint64_t));
+    if (idx->flgs == NULL || idx->names == NULL || idx->runs == NULL || idx->slots == NULL || idx->seen == NULL) {
+        return CFLG_ERR_NOMEM;
+    }
+    idx->nflgs      = nflgs;
+    idx->slots_mask = nslots - 1;
+    idx->disp       = NULL;
+    idx->tokens     = NULL;
+    idx->fold       = NULL;
+    idx->list       = NULL;
+    idx->parent     = fs->parent ? fs->parent->shared : NULL;
+    memset(idx->shorts, 0, sizeof(idx->shorts));
+    memset(idx->slots, 0, nslots * sizeof(uint32_t));
+    memset(idx->seen, 0, (nflgs + 63) / 64 * sizeof(uint64_t));
+
+    if (fs->match != CFLG_MATCH_EXACT) {
+        idx->fold = cflg_fold_table(fs);
+        if (idx->fold == NULL) {
+            return CFLG_ERR_NOMEM;
+        }
+    }
+
+    uint32_t id = 0;
+    CFLG_FOREACH(f, fs->flgs) {
+        f->id           = id;
+        idx->flgs[id++] = f;
+    }
+
+    // conflicts are found with the short name table and the hash table, O(names) in total
+    int res     = CFLG_OK;
+    idx->nnames = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        CFLG_FOREACH(f, fs->flgs) {
+            // the weak flag is added in the second pass
+            if ((f == weak) != (pass == 1)) {
+                continue;
+            }
+            int err = cflg_index_add(fs, idx, f, f->name, f->name_long, f == weak);
+            // aliases map to the id of their flag
+            CFLG_FOREACH_ALIAS(a, f) {
+                if (err == CFLG_ERR_NOMEM) {
+                    break;
+                }
+                int alias_err = cflg_index_add(fs, idx, f, a->name, a->name_long, f == weak);
+                err           = alias_err != CFLG_OK ? alias_err : err;
+            }
+            if (err == CFLG_ERR_NOMEM) {
+                return err;
+            }
+            if (err != CFLG_OK) {
+                res = CFLG_ERR_FLG_DUPLICATE;
+            }
+        }
+    }
+    uint32_t n = idx->nnames;
+
+    CFLG_FOREACH(f, fs->flgs) {
+        if (f->parser != cflg_parse_enum) {
+            continue;
+        }
+        int err = cflg_enum_build(fs, f);
+        if (err == CFLG_ERR_NOMEM) {
+            return err;
+        }
+        if (err != CFLG_OK) {
+            res = err;
+        }
+    }
+
+    for (cflg_constraint_t *c = fs->constraints; c != NULL; c = c->next) {
+        int err = cflg_constraint_build(fs, idx, c);
+        if (err == CFLG_ERR_NOMEM) {
+            return err;
+        }
+        if (err != CFLG_OK) {
+            res = err;
+        }
+    }
+
+    cflg_sort_names(idx->names, n);
+
+    // sorting moved the names, so refill the hash table
+    memset(idx->slots, 0, nslots * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; ++i) {
+        idx->runs[i] = i == 0 ? 0 : idx->runs[i - 1] + (idx->names[i].id != idx->names[i - 1].id);
+        *cflg_index_slot(idx, idx->names[i].name, idx->names[i].len) = i + 1;
+    }
+
+    fs->index = idx;
+    return res;
+}
+
+// uses the index the flag set came with (e.g. a generated one) instead of building one,
+// help takes id 0 which such indexes reserve for it. only constraints need the arena
+int cflg_flgset_attach_index(cflg_flgset_t *fs, cflg_flg_t *help) {
+    help->id           = 0;
+    fs->index->flgs[0] = help;
+    fs->index->parent  = fs->parent ? fs->parent->shared : NULL;
+
+    int res = CFLG_OK;
+    for (cflg_constraint_t *c = fs->constraints; c != NULL; c = c->next) {
+        int err = cflg_constraint_build(fs, fs->index, c);
+        if (err == CFLG_ERR_NOMEM) {
+            return err;
+        }
+        if (err != CFLG_OK) {
+            res = err;
+        }
+    }
+    return res;
+}
+
+#define CFLG_FOLD(fold, c) ((fold) ? (fold)[(unsigned char) (c)] : (unsigned char) (c))
+
+// 2 if name is opt[0..opt_len), 1 if it starts with it, 0 otherwise; both are folded
+// by fold if it isn't NULL
+int cflg_name_match(const char *name, const char *opt, uint32_t opt_len, const unsigned char *fold) {
+    if (CFLG_ISEMPTY(name)) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < opt_len; ++i) {
+        if (name[i] == '\0' || CFLG_FOLD(fold, name[i]) != CFLG_FOLD(fold, opt[i])) {
+            return 0;
+        }
+    }
+    return name[opt_len] == '\0' ? 2 : 1;
+}
+
+// whether f or one of its aliases is named -name or --name_long, under the matching
+// policy of idx
+bool cflg_flg_named(cflg_index_t *idx, cflg_flg_t *f, char name, const char *name_long) {
+    uint32_t len = CFLG_STRLEN(name_long);
+    if ((name && f->name == name) || (len && cflg_name_match(f->name_long, name_long, len, idx->fold) == 2)) {
+        return true;
+    }
+    CFLG_FOREACH_ALIAS(a, f) {
+        if ((name && a->name == name) || (len && cflg_name_match(a->name_long, name_long, len, idx->fold) == 2)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// scans the flags of a list index for a long option, true if one is named exactly like it.
+// otherwise *found is the number of flags it is a prefix of, and *res the last of them
+bool cflg_list_find_long(cflg_index_t *idx, const char *opt, uint32_t opt_len, cflg_flg_t **res,
+                         uint32_t *found) {
+    CFLG_FOREACH(f, idx->list) {
+        int m = cflg_name_match(f->name_long, opt, opt_len, idx->fold);
+        CFLG_FOREACH_ALIAS(a, f) {
+            int alias_m = cflg_name_match(a->name_long, opt, opt_len, idx->fold);
+            m           = alias_m > m ? alias_m : m;
+        }
+        if (m == 2) {
+            *res = f;
+            return true;
+        }
+        if (m == 1) {
+            *res = f;
+            (*found)++;
+        }
+    }
+    return false;
+}
+
+// builds an index without tables, whose lookups scan the flags (see cflg_index_t.list),
+// in a few hundred bytes of the arena. used when the tables don't fit in the stack buffer:
+// names defined twice aren't reported, only the names of `weak` give way to other flags
+int cflg_flgset_list(cflg_flgset_t *fs, cflg_flg_t *weak) {
+    cflg_index_t *idx = cflg_arena_alloc(&fs->arena, sizeof(cflg_index_t));
+    if (idx == NULL) {
+        return CFLG_ERR_NOMEM;
+    }
+    *idx = (cflg_index_t) {.list = fs->flgs, .parent = fs->parent ? fs->parent->shared : NULL};
+    if (fs->match != CFLG_MATCH_EXACT) {
+        idx->fold = cflg_fold_table(fs);
+        if (idx->fold == NULL) {
+            return CFLG_ERR_NOMEM;
+        }
+    }
+
+    CFLG_FOREACH(f, fs->flgs) {
+        if (weak != NULL && f != weak) {
+            weak->name      = cflg_flg_named(idx, f, weak->name, NULL) ? 0 : weak->name;
+            weak->name_long = cflg_flg_named(idx, f, 0, weak->name_long) ? NULL : weak->name_long;
+        }
+        // choices are scanned too, a table of an earlier parse may point to a stack gone since
+        if (f->parser == cflg_parse_enum) {
+            ((cflg_enum_t *) f->dest)->table = NULL;
+        }
+    }
+    fs->index = idx;
+    return CFLG_OK;
+}
+
+// finds the range [*lo, *hi) of names which start with opt[0..opt_len)
+void cflg_index_range(cflg_index_t *idx, const char *opt, uint32_t opt_len, uint32_t *lo, uint32_t *hi) {
+    uint32_t l = 0, h = idx->nnames;
+    while (l < h) {
+        uint32_t mid = l + (h - l) / 2;
+        if (cflg_cmp_prefix(&idx->names[mid], opt, opt_len, idx->fold) < 0) {
+            l = mid + 1;
+        } else {
+            h = mid;
+        }
+    }
+    *lo = l;
+
+    h = idx->nnames;
+    while (l < h) {
+        uint32_t mid = l + (h - l) / 2;
+        if (cflg_cmp_prefix(&idx->names[mid], opt, opt_len, idx->fold) <= 0) {
+            l = mid + 1;
+        } else {
+            h = mid;
+        }
+    }
+    *hi = l;
+}
+
+// returns the position of name[0..len) in the sorted names + 1, or 0 if it isn't there
+uint32_t cflg_index_find(cflg_index_t *idx, const char *name, uint32_t len) {
+    if (idx->disp == NULL) {
+        return *cflg_index_slot(idx, name, len);
+    }
+    if (idx->nnames == 0) {
+        return 0;
+    }
+    uint32_t     d     = idx->disp[cflg_hash_fold(name, len, 0, idx->fold) % idx->ndisp];
+    uint32_t     slot  = idx->slots[cflg_hash_fold(name, len, d, idx->fold) % idx->nnames];
+    cflg_name_t *other = &idx->names[slot - 1];
+    return other->len == len && !cflg_memcmp_fold(other->name, name, len, idx->fold) ? slot : 0;
+}
+
+// looks up a long option in idx and then in its parents, an exact match in any of them wins
+// over partial matches, which must all belong to one flag
+int cflg_index_find_long(cflg_index_t *idx, const char *opt, uint32_t opt_len, cflg_flg_t **res) {
+    *res           = NULL;
+    uint32_t found = 0;
+
+    // a flag set without tables is scanned first, its parents always have them
+    if (idx != NULL && idx->list != NULL) {
+        if (cflg_list_find_long(idx, opt, opt_len, res, &found)) {
+            return CFLG_OK;
+        }
+        idx = idx->parent;
+    }
+
+    // exact match
+    for (cflg_index_t *i = idx; i != NULL; i = i->parent) {
+        uint32_t slot = cflg_index_find(i, opt, opt_len);
+        if (slot) {
+            *res = i->flgs[i->names[slot - 1].id];
+            return CFLG_OK;
+        }
+    }
+
+    // partial match, names with the same prefix are adjacent in the sorted list
+    for (cflg_index_t *i = idx; i != NULL; i = i->parent) {
+        uint32_t lo, hi;
+        cflg_index_range(i, opt, opt_len, &lo, &hi);
+        if (lo == hi) {
+            continue;
+        }
+        if (i->runs[hi - 1] != i->runs[lo] || found) {
+            *res = NULL;
+            return CFLG_ERR_OPT_AMBIGUOUS;
+        }
+        *res  = i->flgs[i->names[lo].id];
+        found = 1;
+    }
+    if (found > 1) {
+        *res = NULL;
+        return CFLG_ERR_OPT_AMBIGUOUS;
+    }
+    return found ? CFLG_OK : CFLG_ERR_OPT_INVALID;
+}
+
+// looks up a short option in idx and then in its parents
+cflg_flg_t *cflg_index_find_short(cflg_index_t *idx, char opt) {
+    for (cflg_index_t *i = idx; i != NULL; i = i->parent) {
+        if (i->list != NULL) {
+            CFLG_FOREACH(f, i->list) {
+                if (opt && cflg_flg_named(i, f, opt, NULL)) {
+                    return f;
+                }
+            }
+            continue;
+        }
+        uint32_t id = i->shorts[(unsigned char) opt];
+        if (id) {
+            return i->flgs[id - 1];
+        }
+    }
+    return NULL;
+}
+
+// marks f as seen in the index it belongs to, which may be a parent of idx
+void cflg_index_mark(cflg_index_t *idx, cflg_flg_t *f) {
+    for (cflg_index_t *i = idx; i != NULL; i = i->parent) {
+        if (f->id < i->nflgs && i->flgs[f->id] == f) {
+            i->seen[f->id / 64] |= (uint64_t) 1 << (f->id % 64);
+            return;
+        }
+    }
+}
+
+// same as cflg_index_find_long, but if no name matches, --no-<name> resolves to a negatable flag
+// named <name> with negated set. real names starting with no- take precedence
+int cflg_index_resolve(cflg_index_t *idx, const char *opt, uint32_t opt_len, cflg_flg_t **res, bool *negated) {
+    *negated = false;
+    int err  = cflg_index_find_long(idx, opt, opt_len, res);
+    if (err != CFLG_ERR_OPT_INVALID || opt_len <= 3 || cflg_memcmp_fold("no-", opt, 3, idx->fold)) {
+        return err;
+    }
+
+    cflg_flg_t *f = NULL;
+    if (cflg_index_find_long(idx, opt + 3, opt_len - 3, &f) != CFLG_OK || f == NULL || !f->negatable) {
+        return err;
+    }
+    *res     = f;
+    *negated = true;
+    return CFLG_OK;
+}
+
+int cflg_flgset_find_long(cflg_flgset_t *fs, const char *opt, uint32_t opt_len, cflg_flg_t **res) {
+    return cflg_index_find_long(fs->index, opt, opt_len, res);
+}
+
+cflg_flg_t *cflg_flgset_find_short(cflg_flgset_t *fs, char opt) {
+    return cflg_index_find_short(fs->index, opt);
+}
+void cflg_swap_args(char *argv[], int i, int j) {
+    if (i != j) {
+        char *tmp = argv[i];
+        argv[i]   = argv[j];
+        argv[j]   = tmp;
+    }
+}
+
+int cflg_flgset_parse_one_long(cflg_flgset_t *fs, int argc, char *const argv[], cflg_parser_context_t *ctx,
+                               int *curr_index) {
+
+    // search for '=' in flag
+    ctx->arg = strchr(ctx->opt, '=');
+    // if there is '=' (e.g. --count=3)
+    if (ctx->arg) {
+        ctx->is_arg_forced = true;
+        ctx->opt_len       = ctx->arg - ctx->opt;
+        ctx->arg++;
+    }
+    // if there is NOT '=' (e.g. --count 3)
+    else {
+        ctx->is_arg_forced = false;
+        ctx->opt_len       = CFLG_STRLEN(ctx->opt);
+        ctx->arg           = argv[*curr_index + 1];
+    }
+
+    // the lookup may have been done ahead of time (see cflg_flgset_resolve)
+    cflg_flg_t *f   = NULL;
+    int         res = CFLG_OK;
+    int32_t     tok = fs->index->tokens ? fs->index->tokens[*curr_index] : 0;
+    if (tok > 0) {
+        f               = fs->index->flgs[(tok & ~CFLG_TOKEN_NEGATED) - 1];
+        ctx->is_negated = (tok & CFLG_TOKEN_NEGATED) != 0;
+    } else if (tok < 0) {
+        res = tok;
+    } else {
+        res = cflg_index_resolve(fs->index, ctx->opt, ctx->opt_len, &f, &ctx->is_negated);
+    }
+    if (res != CFLG_OK) {
+        return res;
+    }
+
+    // if ctx->arg is an empty string (e.g. --count=)
+    if (CFLG_ISEMPTY(ctx->arg)) {
+        ctx->arg = NULL;
+    }
+    ctx->has_been_parsed = f->has_seen;
+    ctx->dest            = f->dest;
+    ctx->flg             = f;
+
+    res = f->parser(ctx);
+
+    if (res == CFLG_OK_NO_ARG) {
+        if (ctx->is_arg_forced) {
+            return CFLG_ERR_ARG_FORCED;
+        }
+        ctx->opt = NULL;
+    } else {
+        // if it's CFLG_OK, CFLG_ERR_ARG_NEEDED, CFLG_ERR_ARG_INVALID or CFLG_ERR_ARG_FORCED
+        if (res == CFLG_OK) {
+            ctx->opt = NULL;
+        }
+        if (!ctx->is_arg_forced) {
+            ++(*curr_index);
+        }
+    }
+
+    f->has_seen = true;
+    cflg_index_mark(fs->index, f);
+
+    return res;
+}
+
+int cflg_flgset_parse_one(cflg_flgset_t *fs, int argc, char *const argv[], cflg_parser_context_t *ctx, int *curr_index) {
+
+    if (fs->parsed) {
+        return CFLG_PARSE_FINISH;
+    }
+
+    // Advance to the next argv element
+    if (CFLG_ISEMPTY(ctx->opt)) {
+
+        ++(*curr_index);
+        if (*curr_index == argc) {
+            fs->parsed = true;
+            return CFLG_PARSE_FINISH;
+        }
+
+        const char *curr_arg = argv[*curr_index];
+        if (CFLG_IS_NONFLG(curr_arg)) {
+            return CFLG_PARSE_NONFLG;
+        }
+
+        // get rid of the '-'
+        ctx->opt = curr_arg + 1;
+
+        // if it startes with '--'
         if (ctx->opt[0] == '-') {
             // special argv element '--' means forced end of options
             // reports end of parsing to the caller
@@ -571,19 +2383,14 @@ int cflg_flgset_parse_one(cflg_flgset_t *fs, int argc, char *argv[], cflg_parser
     }
 
     // ctx->is_opt_short is true, so process the the short option
-    cflg_flg_t *f = NULL;
-    CFLG_FOREACH(i, fs->flgs) {
-        if (i->name == *(ctx->opt)) {
-            f = i;
-            break;
-        }
-    }
+    cflg_flg_t *f = cflg_flgset_find_short(fs, *(ctx->opt));
     if (f == NULL) {
         return CFLG_ERR_OPT_INVALID;
     }
 
-    ctx->arg     = ctx->opt + 1;
-    bool advance = false;
+    ctx->arg        = ctx->opt + 1;
+    ctx->is_negated = false;
+    bool advance    = false;
     if (CFLG_ISEMPTY(ctx->arg)) {
         advance  = true;
         ctx->arg = argv[*curr_index + 1];
@@ -591,6 +2398,7 @@ int cflg_flgset_parse_one(cflg_flgset_t *fs, int argc, char *argv[], cflg_parser
 
     ctx->has_been_parsed = f->has_seen;
     ctx->dest            = f->dest;
+    ctx->flg             = f;
 
     int res = f->parser(ctx);
     if (res == CFLG_OK_NO_ARG) {
@@ -600,17 +2408,355 @@ int cflg_flgset_parse_one(cflg_flgset_t *fs, int argc, char *argv[], cflg_parser
         if (res == CFLG_OK) {
             ctx->opt = NULL;
         }
-        if (advance) {
-            ++(*curr_index);
+        if (advance) {
+            ++(*curr_index);
+        }
+    }
+
+    f->has_seen = true;
+    cflg_index_mark(fs->index, f);
+
+    return res;
+}
+
+// a list index has no bits, its flags remember it themselves
+#define CFLG_SEEN(idx, f) ((idx)->list ? (f)->has_seen : (idx)->seen[(f)->id / 64] >> ((f)->id % 64) & 1)
+
+// prints the long name of a flag if it has one, otherwise its short name
+void cflg_print_flg_name(cflg_flg_t *f) {
+    if (!CFLG_ISEMPTY(f->name_long)) {
+        cflg_fprintf(CFLG_STDERR, "'--%s'", f->name_long);
+    } else {
+        cflg_fprintf(CFLG_STDERR, "'-%c'", f->name);
+    }
+}
+
+// prints flags of a constraint's group as a list, only the ones seen (or not seen) if filter is set
+void cflg_print_group(cflg_index_t *idx, cflg_constraint_t *c, bool filter, bool seen) {
+    bool first = true;
+    for (cflg_flg_t *const *g = c->group; *g; ++g) {
+        if (filter && CFLG_SEEN(idx, *g) != seen) {
+            continue;
+        }
+        cflg_fprintf(CFLG_STDERR, first ? "" : ", ");
+        cflg_print_flg_name(*g);
+        first = false;
+    }
+}
+
+// checks every constraint of the flag set with a few word operations each,
+// reports the violated ones and returns CFLG_ERR_CONSTRAINT if there is any
+int cflg_flgset_check(cflg_flgset_t *fs) {
+    cflg_index_t *idx = fs->index;
+    int           res = CFLG_OK;
+
+    for (cflg_constraint_t *c = fs->constraints; c != NULL; c = c->next) {
+        // number of seen flags of the group saturated at 2, and whether all of them are seen
+        int  count = 0;
+        bool all   = true;
+        for (uint32_t w = 0; w < c->nwords && idx->list == NULL; ++w) {
+            uint64_t x = idx->seen[c->word + w] & c->mask[w];
+            all        = all && x == c->mask[w];
+            count += x == 0 ? 0 : (x & (x - 1)) ? 2 : 1;
+        }
+        // groups aren't compiled without tables, so their flags are counted one by one
+        for (cflg_flg_t *const *g = c->group; *g && idx->list != NULL; ++g) {
+            all = all && (*g)->has_seen;
+            count += (*g)->has_seen && count < 2;
+        }
+
+        bool ok = true;
+        switch (c->kind) {
+        case CFLG_REQUIRED:
+            ok = all;
+            break;
+        case CFLG_EXACTLY_ONE:
+            ok = count == 1;
+            break;
+        case CFLG_AT_MOST_ONE:
+            ok = count <= 1;
+            break;
+        case CFLG_ALL_OR_NONE:
+            ok = count == 0 || all;
+            break;
+        case CFLG_REQUIRES:
+            ok = !CFLG_SEEN(idx, c->trigger) || all;
+            break;
+        }
+        if (ok) {
+            continue;
+        }
+
+        cflg_fprintf(CFLG_STDERR, "%s: ", fs->prog_name);
+        if (c->kind == CFLG_REQUIRES) {
+            cflg_fprintf(CFLG_STDERR, "option ");
+            cflg_print_flg_name(c->trigger);
+            cflg_fprintf(CFLG_STDERR, " requires ");
+            cflg_print_group(idx, c, true, false);
+        } else if (c->kind == CFLG_REQUIRED || (c->kind == CFLG_EXACTLY_ONE && count == 0)) {
+            cflg_fprintf(CFLG_STDERR, c->kind == CFLG_REQUIRED ? "missing required option " : "one of the options ");
+            cflg_print_group(idx, c, c->kind == CFLG_REQUIRED, false);
+            cflg_fprintf(CFLG_STDERR, c->kind == CFLG_REQUIRED ? "" : " is required");
+        } else if (c->kind == CFLG_ALL_OR_NONE) {
+            cflg_fprintf(CFLG_STDERR, "options ");
+            cflg_print_group(idx, c, false, false);
+            cflg_fprintf(CFLG_STDERR, " must be used together");
+        } else {
+            cflg_fprintf(CFLG_STDERR, "options ");
+            cflg_print_group(idx, c, true, true);
+            cflg_fprintf(CFLG_STDERR, " are mutually exclusive");
+        }
+        cflg_fprintf(CFLG_STDERR, "\n");
+        res = CFLG_ERR_CONSTRAINT;
+    }
+
+    return res;
+}
+
+#ifdef CFLG_THREADS
+
+// a range of argv whose long options are looked up by one thread
+typedef struct {
+    cflg_index_t *idx;
+    char *const  *argv;
+    int           begin;
+    int           end;
+} cflg_chunk_t;
+
+// whether an element is the argument of the flag before it is only known to the sequential
+// pass, so every element which looks like a long option is looked up; the results of the
+// others are never read, which lets chunks start anywhere
+void *cflg_resolve_chunk(void *arg) {
+    cflg_chunk_t *c = arg;
+    for (int i = c->begin; i < c->end; ++i) {
+        const char *s  = c->argv[i];
+        c->idx->tokens[i] = 0;
+        if (CFLG_IS_NONFLG(s) || s[1] != '-' || s[2] == '\0') {
+            continue;
+        }
+        const char *opt = s + 2;
+        const char *eq  = strchr(opt, '=');
+        uint32_t    len = eq ? (uint32_t) (eq - opt) : (uint32_t) strlen(opt);
+        cflg_flg_t *f       = NULL;
+        bool        negated = false;
+        int         res     = cflg_index_resolve(c->idx, opt, len, &f, &negated);
+        c->idx->tokens[i]   = res == CFLG_OK ? ((int32_t) f->id + 1) | (negated ? CFLG_TOKEN_NEGATED : 0) : res;
+        // ids of a parent's flags refer to its own index, those are looked up again
+        if (res == CFLG_OK && (f->id >= c->idx->nflgs || c->idx->flgs[f->id] != f)) {
+            c->idx->tokens[i] = 0;
+        }
+    }
+    return NULL;
+}
+
+// looks up the long options of argv on fs->threads threads, the calling thread included.
+// the index is read-only by now, so the threads share it without locking
+void cflg_flgset_resolve(cflg_flgset_t *fs, int argc, char *const argv[]) {
+    int nthreads = fs->threads < CFLG_MAX_THREADS ? fs->threads : CFLG_MAX_THREADS;
+    if (nthreads < 2 || argc < CFLG_THREADS_MIN_ARGS || fs->index->list != NULL) {
+        return;
+    }
+    int32_t *tokens = cflg_arena_alloc(&fs->arena, argc * sizeof(int32_t));
+    if (tokens == NULL) {
+        return;
+    }
+    fs->index->tokens = tokens;
+
+    pthread_t    threads[CFLG_MAX_THREADS];
+    bool         started[CFLG_MAX_THREADS];
+    cflg_chunk_t chunks[CFLG_MAX_THREADS];
+    for (int t = 0; t < nthreads; ++t) {
+        chunks[t] = (cflg_chunk_t) {.idx   = fs->index,
+                                    .argv  = argv,
+                                    .begin = (int) ((int64_t) argc * t / nthreads),
+                                    .end   = (int) ((int64_t) argc * (t + 1) / nthreads)};
+    }
+    for (int t = 1; t < nthreads; ++t) {
+        started[t] = pthread_create(&threads[t], NULL, cflg_resolve_chunk, &chunks[t]) == 0;
+    }
+    cflg_resolve_chunk(&chunks[0]);
+    // chunks of threads which couldn't be started are done here
+    for (int t = 1; t < nthreads; ++t) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            cflg_resolve_chunk(&chunks[t]);
+        }
+    }
+}
+
+#endif
+
+// makes argv[i] the n-th non-flag argument, by moving it there or by recording its index
+void cflg_keep_arg(char *argv[], int *positionals, int i, int n) {
+    if (positionals) {
+        positionals[n] = i;
+    } else {
+        cflg_swap_args(argv, i, n);
+    }
+}
+
+// the rest of cflg_flgset_run, whose help flag is the head of fset->flgs. on_stack is set
+// if the arena is the stack buffer of cflg_flgset_run_on_stack
+// reports a name of the child flag set fs which one of the parents idx already has
+bool cflg_link_check_name(cflg_flgset_t *fs, cflg_index_t *idx, char name, const char *name_long) {
+    const char *prog = CFLG_FALLBACK(fs->prog_name, "cflg");
+    bool        ok   = true;
+    if (name && cflg_index_find_short(idx, name) != NULL) {
+        cflg_fprintf(CFLG_STDERR, "%s: flag '-%c' is also defined by a parent flag set\n", prog, name);
+        ok = false;
+    }
+    if (CFLG_ISEMPTY(name_long)) {
+        return ok;
+    }
+    for (cflg_index_t *i = idx; i != NULL; i = i->parent) {
+        if (cflg_index_find(i, name_long, strlen(name_long))) {
+            cflg_fprintf(CFLG_STDERR, "%s: flag '--%s' is also defined by a parent flag set\n", prog, name_long);
+            return false;
+        }
+    }
+    return ok;
+}
+
+// reports every name of the flags of fs, except those of weak (the implicit help flag),
+// which one of the parents idx already has
+bool cflg_link_check(cflg_flgset_t *fs, cflg_index_t *idx, cflg_flg_t *weak) {
+    bool ok = true;
+    CFLG_FOREACH(f, fs->flgs) {
+        if (f == weak) {
+            continue;
+        }
+        ok = cflg_link_check_name(fs, idx, f->name, f->name_long) && ok;
+        CFLG_FOREACH_ALIAS(a, f) {
+            ok = cflg_link_check_name(fs, idx, a->name, a->name_long) && ok;
+        }
+    }
+    return ok;
+}
+
+int cflg_flgset_run_(cflg_flgset_t *fset, int argc, char *argv[], int *positionals, bool *is_help, bool on_stack) {
+    cflg_flg_t *help     = fset->flgs;
+    bool        prebuilt = fset->index != NULL;
+    int         res      = CFLG_OK;
+    if (prebuilt) {
+        res = cflg_flgset_attach_index(fset, help);
+    } else if (on_stack && cflg_flgset_size(fset, false) > fset->arena.cap) {
+        res = cflg_flgset_list(fset, help);
+    } else {
+        res = cflg_flgset_index(fset, help);
+    }
+    // flags added since cflg_flgset_link haven't been checked against the parents
+    if (res == CFLG_OK && !prebuilt && fset->parent != NULL && !cflg_link_check(fset, fset->parent->shared, help)) {
+        res = CFLG_ERR_FLG_DUPLICATE;
+    }
+    // if the user has defined '-h', don't show it as help
+    if (res == CFLG_OK && cflg_flgset_find_short(fset, help->name) != help) {
+        help->name = 0;
+    }
+    if (res == CFLG_ERR_NOMEM) {
+        cflg_fprintf(CFLG_STDERR, "%s: not enough memory for flags, %zu bytes of arena needed\n", fset->prog_name,
+                     cflg_flgset_size(fset, false));
+    }
+
+    // failures end parsing with status, which is turned into exit() once the flag set is
+    // cleaned up (or returned, in freestanding builds)
+    int status = res == CFLG_OK ? CFLG_OK : CFLG_PARSE_FAILED;
+
+    // parent indexes are shared by every child linked to them, forget what the parse of
+    // another child has seen
+    for (cflg_index_t *i = status == CFLG_OK ? fset->index->parent : NULL; i != NULL; i = i->parent) {
+        memset(i->seen, 0, (i->nflgs + 63) / 64 * sizeof(uint64_t));
+    }
+
+#ifdef CFLG_THREADS
+    if (status == CFLG_OK) {
+        cflg_flgset_resolve(fset, argc, argv);
+    }
+#endif
+
+    int                   last_nonopt = 0;
+    int                   curr_index  = 0; // argv[0] is always assumed to be the name of the executable
+    cflg_parser_context_t ctx         = {0};
+    if (positionals) {
+        positionals[0] = 0;
+    }
+
+    while (status == CFLG_OK) {
+        int res = cflg_flgset_parse_one(fset, argc, argv, &ctx, &curr_index);
+        if (res == CFLG_PARSE_FINISH) {
+            break;
+        }
+        // if it was a non flag
+        if (res == CFLG_PARSE_NONFLG) {
+            cflg_keep_arg(argv, positionals, curr_index, ++last_nonopt);
+            // in POSIX mode, it ends the flags like '--' does
+            if (fset->posix) {
+                break;
+            }
+            continue;
+        }
+        // if there was an error
+        if (res != CFLG_OK && res != CFLG_OK_NO_ARG) {
+            cflg_print_err(res, fset, &ctx);
+            status = CFLG_PARSE_FAILED;
+        }
+        // if help was requested
+        else if (*is_help) {
+            fset->usage(fset);
+            status = CFLG_PARSE_HELP;
+        }
+    }
+
+    if (status == CFLG_OK) {
+        for (curr_index = curr_index + 1; curr_index < argc; ++curr_index) {
+            cflg_keep_arg(argv, positionals, curr_index, ++last_nonopt);
+        }
+        if (cflg_flgset_check(fset) != CFLG_OK) {
+            cflg_fprintf(CFLG_STDERR, "Try '%s --help' for more information.\n", fset->prog_name);
+            status = CFLG_PARSE_FAILED;
         }
     }
 
-    f->has_seen = true;
+    // remove help flag, because after returning from this function
+    // it will be deallocated
+    fset->flgs   = fset->flgs->next;
+
+    // the index refers to the help flag and maybe to the stack
+    if (prebuilt) {
+        fset->index->flgs[0] = NULL;
+        fset->index->tokens  = NULL;
+    } else {
+        fset->index = NULL;
+    }
+
+    if (status != CFLG_OK) {
+#ifdef CFLG_FREESTANDING
+        return status;
+#else
+        exit(status == CFLG_PARSE_HELP ? 0 : 1);
+#endif
+    }
 
+    fset->narg        = last_nonopt + 1;
+    fset->positionals = positionals;
+    fset->parsed      = true;
+
+    // return the number of processed arguments
+    return argc - fset->narg;
+}
+
+// cflg_flgset_run_ with a stack buffer as the arena, which only flag sets without an arena
+// pay for. if their index doesn't fit there, their flags are scanned instead
+int cflg_flgset_run_on_stack(cflg_flgset_t *fset, int argc, char *argv[], int *positionals, bool *is_help) {
+    uint64_t stack_mem[CFLG_STACK_ARENA_SIZE / sizeof(uint64_t)];
+    fset->arena = (cflg_arena_t) {.base = (unsigned char *) stack_mem, .cap = sizeof(stack_mem)};
+    int res     = cflg_flgset_run_(fset, argc, argv, positionals, is_help, true);
+    fset->arena = (cflg_arena_t) {0};
     return res;
 }
 
-int cflg_flgset_parse(cflg_flgset_t *fset, int argc, char *argv[]) {
+// parses argv, which is only written if positionals is NULL
+int cflg_flgset_run(cflg_flgset_t *fset, int argc, char *argv[], int *positionals) {
 
     if (fset->parsed)
         return argc - fset->narg;
@@ -637,49 +2783,977 @@ int cflg_flgset_parse(cflg_flgset_t *fset, int argc, char *argv[]) {
     bool is_help = false;
     cflg_flgset_bool(fset, &is_help, 'h', "help", "print this help");
 
-    int                   last_nonopt = 0;
-    int                   curr_index  = 0; // argv[0] is always assumed to be the name of the executable
-    cflg_parser_context_t ctx         = {0};
+    // without an arena, the index lives on the stack until parsing is over
+    if (fset->arena.base == NULL && fset->arena.grow == NULL) {
+        return cflg_flgset_run_on_stack(fset, argc, argv, positionals, &is_help);
+    }
+    return cflg_flgset_run_(fset, argc, argv, positionals, &is_help, false);
+}
+
+int cflg_flgset_parse(cflg_flgset_t *fset, int argc, char *argv[]) {
+    return cflg_flgset_run(fset, argc, argv, NULL);
+}
+
+int cflg_flgset_parse_const(cflg_flgset_t *fset, int argc, char *const argv[], int *positionals) {
+    if (fset->parsed) {
+        return argc - fset->narg;
+    }
+    if (positionals == NULL) {
+        positionals = cflg_arena_alloc(&fset->arena, argc * sizeof(int));
+    }
+    if (positionals == NULL) {
+        cflg_fprintf(CFLG_STDERR, "%s: not enough memory for positional arguments, %zu bytes of arena needed\n",
+                     CFLG_FALLBACK(fset->prog_name, argv[0]), CFLG_ALIGN_UP(argc * sizeof(int)));
+#ifdef CFLG_FREESTANDING
+        return CFLG_PARSE_FAILED;
+#else
+        exit(1);
+#endif
+    }
+    // argv is only read when positionals is set
+    return cflg_flgset_run(fset, argc, (char **) argv, positionals);
+}
+
+const char *cflg_flgset_arg(cflg_flgset_t *fset, int i) {
+    return fset->positionals ? fset->args[fset->positionals[i]] : fset->args[i];
+}
+
+bool cflg_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+int cflg_split(char *line, char **tokens, int cap) {
+    if (cap < 1) {
+        return CFLG_SPLIT_FULL;
+    }
+    // words are written behind the read position, every removed quote, escape or
+    // separator leaves room for the terminator
+    int   n = 0;
+    char *r = line, *w = line;
+    for (;;) {
+        while (cflg_is_blank(*r)) {
+            r++;
+        }
+        if (*r == '\0') {
+            break;
+        }
+        if (n + 1 >= cap) {
+            return CFLG_SPLIT_FULL;
+        }
+        tokens[n++] = w;
+
+        char quote = 0;
+        for (; *r != '\0' && (quote || !cflg_is_blank(*r)); ++r) {
+            if (*r == quote) {
+                quote = 0;
+            } else if (quote == 0 && (*r == '\'' || *r == '"')) {
+                quote = *r;
+            } else if (*r == '\\' && (quote == 0 || (quote == '"' && r[1] && strchr("\"\\$`", r[1])))) {
+                if (*++r == '\0') {
+                    return CFLG_SPLIT_UNCLOSED;
+                }
+                *w++ = *r;
+            } else {
+                *w++ = *r;
+            }
+        }
+        if (quote) {
+            return CFLG_SPLIT_UNCLOSED;
+        }
+        char end = *r;
+        *w++     = '\0';
+        if (end == '\0') {
+            break;
+        }
+        r++;
+    }
+    tokens[n] = NULL;
+    return n;
+}
+
+int cflg_flgset_parse_line(cflg_flgset_t *fset, char *line, char **tokens, int cap) {
+    // line already holds the words of the first call, splitting it again would
+    // overwrite fset->args
+    if (fset->parsed) {
+        return 0;
+    }
+    int n = cap < 2 ? CFLG_SPLIT_FULL : cflg_split(line, tokens, cap);
+    if (n < 0) {
+        cflg_fprintf(CFLG_STDERR, "%s: %s\n", CFLG_FALLBACK(fset->prog_name, "cflg"),
+                     n == CFLG_SPLIT_FULL ? "too many arguments" : "unterminated quote or escape");
+#ifdef CFLG_FREESTANDING
+        return CFLG_PARSE_FAILED;
+#else
+        exit(1);
+#endif
+    }
+    // an empty line is a command without a name
+    if (n == 0) {
+        tokens[n++] = line + strlen(line);
+        tokens[n]   = NULL;
+    }
+    return cflg_flgset_run(fset, n, tokens, NULL);
+}
+
+// identifies snapshots, checked before anything else when restoring
+#define CFLG_SNAPSHOT_MAGIC 0x67666c63u // "cflg"
+// length of a NULL string in a snapshot
+#define CFLG_SNAPSHOT_NULL UINT32_MAX
+
+// header of a snapshot, followed by narg argument pointers which are filled in when
+// restoring, then a record per flag (seen byte and value) and the positionals
+typedef struct {
+    uint32_t magic;  // CFLG_SNAPSHOT_MAGIC
+    uint32_t schema; // cflg_flgset_schema_hash of the flag set
+    uint32_t size;   // total size of the snapshot in bytes
+    uint32_t narg;   // number of positionals, including argv[0]
+} cflg_snapshot_t;
+
+// bounded cursor over a snapshot, writes past cap are only counted
+typedef struct {
+    unsigned char *buf;
+    size_t         off;
+    size_t         cap;
+} cflg_cursor_t;
+
+// item types of array flags
+#define CFLG_ARRAY_INT    0
+#define CFLG_ARRAY_INT64  1
+#define CFLG_ARRAY_DOUBLE 2
+
+static const uint32_t cflg_array_sizes[] = {sizeof(int), sizeof(int64_t), sizeof(double)};
+
+// value types whose destinations can be saved: the first ones in the order of
+// cflg_value_sizes, then the arrays (in the order of cflg_array_sizes), maps and lazy flags
+static const cflg_parser_t cflg_value_parsers[] = {cflg_parse_bool,        cflg_parse_int,
+                                                   cflg_parse_uint,        cflg_parse_int64,
+                                                   cflg_parse_uint64,      cflg_parse_float,
+                                                   cflg_parse_double,      cflg_parse_string,
+                                                   cflg_parse_enum,        cflg_parse_int_array,
+                                                   cflg_parse_int64_array, cflg_parse_double_array,
+                                                   cflg_parse_map,         cflg_parse_lazy};
+static const uint32_t      cflg_value_sizes[]   = {sizeof(bool),   sizeof(int),     sizeof(unsigned int),
+                                                   sizeof(int64_t), sizeof(uint64_t), sizeof(float),
+                                                   sizeof(double), sizeof(char *),  sizeof(int)};
+
+#define CFLG_VALUE_STRING 7
+#define CFLG_VALUE_ENUM   8
+#define CFLG_VALUE_ARRAY  9 // + CFLG_ARRAY_INT, CFLG_ARRAY_INT64 or CFLG_ARRAY_DOUBLE
+#define CFLG_VALUE_MAP    12
+#define CFLG_VALUE_LAZY   13
+#define CFLG_VALUE_CUSTOM 14
+
+// value type of a flag, CFLG_VALUE_CUSTOM if it has a user defined parser
+uint32_t cflg_value_type(cflg_flg_t *f) {
+    uint32_t t = 0;
+    while (t < CFLG_VALUE_CUSTOM && cflg_value_parsers[t] != f->parser) {
+        ++t;
+    }
+    return t;
+}
+
+uint32_t cflg_flgset_schema_hash(cflg_flgset_t *fset) {
+    // the layout of values depends on the pointer size as well
+    uint32_t h = cflg_hash((const char *) &(uint32_t) {sizeof(char *)}, sizeof(uint32_t), CFLG_SNAPSHOT_MAGIC);
+    CFLG_FOREACH(f, fset->flgs) {
+        uint32_t type = cflg_value_type(f);
+        h             = cflg_hash(&f->name, 1, h ^ type);
+        h             = cflg_hash(CFLG_FALLBACK(f->name_long, ""), CFLG_STRLEN(f->name_long), h);
+        if (type == CFLG_VALUE_ENUM) {
+            cflg_enum_t *e = f->dest;
+            for (const char *const *c = e->choices; *c != NULL; ++c) {
+                h = cflg_hash(*c, strlen(*c) + 1, h);
+            }
+        }
+    }
+    return h;
+}
+
+void cflg_cursor_put(cflg_cursor_t *cur, const void *src, size_t n) {
+    if (cur->off + n <= cur->cap) {
+        memcpy(cur->buf + cur->off, src, n);
+    }
+    cur->off += n;
+}
+
+// saves str[0..len) as its length, the characters and a null terminator
+void cflg_cursor_put_n(cflg_cursor_t *cur, const char *str, uint32_t len) {
+    cflg_cursor_put(cur, &len, sizeof(len));
+    if (str) {
+        cflg_cursor_put(cur, str, len);
+        cflg_cursor_put(cur, "", 1);
+    }
+}
+
+// saves a string as its length, the characters and the null terminator
+void cflg_cursor_put_str(cflg_cursor_t *cur, const char *str) {
+    cflg_cursor_put_n(cur, str, str ? (uint32_t) strlen(str) : CFLG_SNAPSHOT_NULL);
+}
+
+// pads the snapshot to CFLG_ARENA_ALIGN, so items of any type can stay in place
+void cflg_cursor_put_pad(cflg_cursor_t *cur) {
+    static const unsigned char zeros[CFLG_ARENA_ALIGN];
+    cflg_cursor_put(cur, zeros, CFLG_ALIGN_UP(cur->off) - cur->off);
+}
+
+// returns a pointer to the next n bytes and skips them, NULL if the snapshot is too short
+void *cflg_cursor_get(cflg_cursor_t *cur, size_t n) {
+    if (n > cur->cap - cur->off) {
+        return NULL;
+    }
+    cur->off += n;
+    return cur->buf + cur->off - n;
+}
+
+// reads a string saved by cflg_cursor_put_str, returns false if the snapshot is too short
+bool cflg_cursor_get_str(cflg_cursor_t *cur, char **str) {
+    uint32_t len;
+    void    *p = cflg_cursor_get(cur, sizeof(len));
+    if (p == NULL) {
+        return false;
+    }
+    memcpy(&len, p, sizeof(len));
+    *str = NULL;
+    if (len == CFLG_SNAPSHOT_NULL) {
+        return true;
+    }
+    *str = cflg_cursor_get(cur, (size_t) len + 1);
+    return *str != NULL && (*str)[len] == '\0';
+}
+
+// saves the value of a flag: scalars as they are, the values of arrays and the pairs of
+// maps, and the argument of a lazy flag, whose parser runs again after restoring
+void cflg_snapshot_value(cflg_cursor_t *cur, cflg_flg_t *f, uint32_t type) {
+    if (type == CFLG_VALUE_STRING) {
+        cflg_cursor_put_str(cur, *(char **) f->dest);
+    } else if (type == CFLG_VALUE_ENUM) {
+        cflg_cursor_put(cur, ((cflg_enum_t *) f->dest)->dest, sizeof(int));
+    } else if (type < CFLG_VALUE_ARRAY) {
+        cflg_cursor_put(cur, f->dest, cflg_value_sizes[type]);
+    } else if (type < CFLG_VALUE_MAP) {
+        cflg_array_t *a = f->dest;
+        cflg_cursor_put(cur, &a->count, sizeof(a->count));
+        cflg_cursor_put(cur, &a->overflow, 1);
+        cflg_cursor_put_pad(cur);
+        if (a->count) {
+            cflg_cursor_put(cur, a->items, (size_t) a->count * cflg_array_sizes[type - CFLG_VALUE_ARRAY]);
+        }
+    } else if (type == CFLG_VALUE_MAP) {
+        cflg_map_t *map = f->dest;
+        cflg_cursor_put(cur, &map->count, sizeof(map->count));
+        for (uint32_t i = 0; map->slots != NULL && i <= map->mask; ++i) {
+            if (map->slots[i].key != NULL) {
+                cflg_cursor_put_n(cur, map->slots[i].key, map->slots[i].key_len);
+                cflg_cursor_put_str(cur, map->slots[i].value);
+            }
+        }
+    } else if (type == CFLG_VALUE_LAZY) {
+        cflg_lazy_t  *l     = f->dest;
+        unsigned char given = f->has_seen && l->ctx.arg != NULL;
+        cflg_cursor_put(cur, &given, 1);
+        if (given) {
+            cflg_cursor_put(cur, &l->ctx.is_opt_short, 1);
+            cflg_cursor_put_n(cur, l->ctx.opt, l->ctx.opt_len);
+            cflg_cursor_put_str(cur, l->ctx.arg);
+        }
+    }
+}
+
+size_t cflg_flgset_snapshot(cflg_flgset_t *fset, void *buf, size_t cap) {
+    cflg_cursor_t   cur = {.buf = buf, .cap = buf ? cap : 0};
+    cflg_snapshot_t hdr = {.magic  = CFLG_SNAPSHOT_MAGIC,
+                           .schema = cflg_flgset_schema_hash(fset),
+                           .narg   = fset->args ? (uint32_t) fset->narg : 0};
+    cur.off             = sizeof(hdr) + CFLG_ALIGN_UP(hdr.narg * sizeof(char *));
+
+    CFLG_FOREACH(f, fset->flgs) {
+        uint32_t type = cflg_value_type(f);
+        cflg_cursor_put(&cur, &f->has_seen, 1);
+        cflg_snapshot_value(&cur, f, type);
+    }
+    for (uint32_t i = 0; i < hdr.narg; ++i) {
+        cflg_cursor_put_str(&cur, cflg_flgset_arg(fset, i));
+    }
+
+    hdr.size = (uint32_t) cur.off;
+    if (cur.off <= cur.cap) {
+        memcpy(buf, &hdr, sizeof(hdr));
+    }
+    return cur.off;
+}
+
+// loads a value saved by cflg_snapshot_value. items of arena-backed arrays and strings
+// stay in the snapshot, the others are copied. returns false if the snapshot is too short
+// or holds more values than the destination has room for
+bool cflg_restore_value(cflg_cursor_t *cur, cflg_flg_t *f, uint32_t type) {
+    if (type == CFLG_VALUE_STRING) {
+        return cflg_cursor_get_str(cur, f->dest);
+    }
+    if (type < CFLG_VALUE_ARRAY) {
+        void *value = cflg_cursor_get(cur, cflg_value_sizes[type]);
+        if (value == NULL) {
+            return false;
+        }
+        void *dest = type == CFLG_VALUE_ENUM ? ((cflg_enum_t *) f->dest)->dest : f->dest;
+        memcpy(dest, value, cflg_value_sizes[type]);
+        return true;
+    }
+    if (type < CFLG_VALUE_MAP) {
+        cflg_array_t  *a        = f->dest;
+        size_t         size     = cflg_array_sizes[type - CFLG_VALUE_ARRAY];
+        void          *count    = cflg_cursor_get(cur, sizeof(uint32_t));
+        unsigned char *overflow = cflg_cursor_get(cur, 1);
+        if (count == NULL || overflow == NULL || cflg_cursor_get(cur, CFLG_ALIGN_UP(cur->off) - cur->off) == NULL) {
+            return false;
+        }
+        uint32_t n;
+        memcpy(&n, count, sizeof(n));
+        void *items = n <= (cur->cap - cur->off) / size ? cflg_cursor_get(cur, n * size) : NULL;
+        if (items == NULL) {
+            return false;
+        }
+        if (a->arena != NULL) {
+            // more values move the items to the arena, as alloc is used up
+            a->items = items;
+            a->alloc = n;
+        } else if (n > a->cap) {
+            return false;
+        } else if (n) {
+            memcpy(a->items, items, n * size);
+        }
+        a->count    = n;
+        a->overflow = *overflow != 0;
+        return true;
+    }
+    if (type == CFLG_VALUE_MAP) {
+        cflg_map_t *map   = f->dest;
+        void       *count = cflg_cursor_get(cur, sizeof(uint32_t));
+        uint32_t    n;
+        if (count == NULL) {
+            return false;
+        }
+        memcpy(&n, count, sizeof(n));
+        if (map->slots == NULL) {
+            return n == 0;
+        }
+        memset(map->slots, 0, ((size_t) map->mask + 1) * sizeof(cflg_map_entry_t));
+        map->count = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            char *key, *value;
+            if (!cflg_cursor_get_str(cur, &key) || key == NULL || !cflg_cursor_get_str(cur, &value) ||
+                map->count + 1 > (map->mask + 1ull) * 3 / 4) {
+                return false;
+            }
+            cflg_map_entry_t *e = cflg_map_slot(map, key, (uint32_t) strlen(key));
+            map->count += e->key == NULL;
+            *e = (cflg_map_entry_t) {.key = key, .key_len = (uint32_t) strlen(key), .value = value};
+        }
+        return true;
+    }
+    if (type == CFLG_VALUE_LAZY) {
+        cflg_lazy_t   *l     = f->dest;
+        unsigned char *given = cflg_cursor_get(cur, 1);
+        if (given == NULL) {
+            return false;
+        }
+        l->pending = *given != 0;
+        if (l->pending) {
+            unsigned char *is_short = cflg_cursor_get(cur, 1);
+            char          *opt, *arg;
+            if (is_short == NULL || !cflg_cursor_get_str(cur, &opt) || opt == NULL ||
+                !cflg_cursor_get_str(cur, &arg) || arg == NULL) {
+                return false;
+            }
+            l->ctx = (cflg_parser_context_t) {.opt          = opt,
+                                              .opt_len      = (uint32_t) strlen(opt),
+                                              .is_opt_short = *is_short != 0,
+                                              .dest         = l->dest,
+                                              .arg          = arg,
+                                              .flg          = f};
+        }
+    }
+    return true;
+}
+
+bool cflg_flgset_restore(cflg_flgset_t *fset, void *buf, size_t size) {
+    cflg_snapshot_t hdr;
+    if (buf == NULL || size < sizeof(hdr) || (uintptr_t) buf % CFLG_ARENA_ALIGN != 0) {
+        return false;
+    }
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.magic != CFLG_SNAPSHOT_MAGIC || hdr.size != size || hdr.schema != cflg_flgset_schema_hash(fset)) {
+        return false;
+    }
+
+    cflg_cursor_t cur  = {.buf = buf, .off = sizeof(hdr), .cap = size};
+    char        **args = cflg_cursor_get(&cur, CFLG_ALIGN_UP(hdr.narg * sizeof(char *)));
+    if (args == NULL) {
+        return false;
+    }
+
+    CFLG_FOREACH(f, fset->flgs) {
+        uint32_t       type = cflg_value_type(f);
+        unsigned char *seen = cflg_cursor_get(&cur, 1);
+        if (seen == NULL) {
+            return false;
+        }
+        f->has_seen = *seen != 0;
+        if (!cflg_restore_value(&cur, f, type)) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < hdr.narg; ++i) {
+        if (!cflg_cursor_get_str(&cur, &args[i])) {
+            return false;
+        }
+    }
+
+    fset->args        = args;
+    fset->narg        = (int) hdr.narg;
+    fset->positionals = NULL;
+    fset->parsed      = true;
+#ifndef PROGRAM_NAME
+    if (fset->prog_name == NULL && hdr.narg > 0 && args[0] != NULL)
+        fset->prog_name = cflg_find_base(args[0]);
+#else
+    fset->prog_name = PROGRAM_NAME;
+#endif
+    return true;
+}
+
+#ifdef CFLG_WATCH
+
+// destination of the value of a flag, enum flags keep theirs behind a cflg_enum_t
+void *cflg_value_dest(cflg_flg_t *f, uint32_t type) {
+    return type == CFLG_VALUE_ENUM ? (void *) ((cflg_enum_t *) f->dest)->dest : f->dest;
+}
+
+// parses the value of a key into w->values, returns false if it's invalid
+bool cflg_watch_parse(cflg_watch_t *w, cflg_flg_t *f, uint32_t type, const char *key, const char *value) {
+    void       *dest = &w->values[f->id];
+    cflg_enum_t e;
+    if (type == CFLG_VALUE_ENUM) {
+        e      = *(cflg_enum_t *) f->dest;
+        e.dest = (int *) dest;
+        dest   = &e;
+    }
+    cflg_parser_context_t ctx = {.opt           = key,
+                                 .opt_len       = strlen(key),
+                                 .is_arg_forced = true,
+                                 .dest          = dest,
+                                 .arg           = value,
+                                 .flg           = f};
+    int res = f->parser(&ctx);
+    return res == CFLG_OK || res == CFLG_OK_NO_ARG;
+}
+
+// removes spaces and tabs from both ends of s[0..*len)
+char *cflg_trim(char *s, size_t *len) {
+    while (*len && (*s == ' ' || *s == '\t' || *s == '\r')) {
+        s++, (*len)--;
+    }
+    while (*len && (s[*len - 1] == ' ' || s[*len - 1] == '\t' || s[*len - 1] == '\r')) {
+        (*len)--;
+    }
+    s[*len] = '\0';
+    return s;
+}
+
+// writes the parsed values of the flags in w->changed to their variables. there is only
+// one writer, readers retry while seq is odd or has moved on (see cflg_watch_read)
+void cflg_watch_publish(cflg_watch_t *w, uint32_t nchanged) {
+    uint32_t seq = __atomic_load_n(&w->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&w->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (uint32_t i = 0; i < nchanged; ++i) {
+        cflg_flg_t *f    = w->index->flgs[w->changed[i]];
+        uint32_t    type = cflg_value_type(f);
+        memcpy(cflg_value_dest(f, type), &w->values[f->id], cflg_value_sizes[type]);
+    }
+    __atomic_store_n(&w->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// reads the file into the half of the buffer readers don't use and publishes what changed
+int cflg_watch_load(cflg_watch_t *w) {
+    const char *prog = CFLG_FALLBACK(w->fset->prog_name, "cflg");
+    char       *text = w->text[(w->gen + 1) & 1];
+
+    FILE *file = fopen(w->path, "rb");
+    if (file == NULL) {
+        cflg_fprintf(CFLG_STDERR, "%s: cannot read '%s'\n", prog, w->path);
+        return -1;
+    }
+    size_t len = fread(text, 1, w->cap, file);
+    fclose(file);
+    if (len == w->cap) {
+        cflg_fprintf(CFLG_STDERR, "%s: '%s' doesn't fit in %zu bytes\n", prog, w->path, w->cap);
+        return -1;
+    }
+    text[len] = '\0';
+
+    uint32_t nchanged = 0, ndiffer = 0, line = 0;
+    for (char *next = text; *next;) {
+        char  *start = next;
+        char  *nl    = strchr(start, '\n');
+        size_t n     = nl ? (size_t) (nl - start) : strlen(start);
+        next         = nl ? nl + 1 : start + n;
+        ++line;
+
+        char *key = cflg_trim(start, &n);
+        char *eq  = strchr(key, '=');
+        if (n == 0 || key[0] == '#') {
+            continue;
+        }
+        if (eq == NULL) {
+            cflg_fprintf(CFLG_STDERR, "%s: %s:%u: expected 'name = value'\n", prog, w->path, line);
+            continue;
+        }
+        size_t key_len = eq - key, value_len = n - key_len - 1;
+        key            = cflg_trim(key, &key_len);
+        char *value    = cflg_trim(eq + 1, &value_len);
+
+        uint32_t slot = cflg_index_find(w->index, key, key_len);
+        if (!slot) {
+            cflg_fprintf(CFLG_STDERR, "%s: %s:%u: unknown option '%s'\n", prog, w->path, line, key);
+            continue;
+        }
+        cflg_flg_t *f    = w->index->flgs[w->index->names[slot - 1].id];
+        uint32_t    type = cflg_value_type(f);
+        if (type >= CFLG_VALUE_ARRAY) {
+            cflg_fprintf(CFLG_STDERR, "%s: %s:%u: option '%s' can't be reloaded\n", prog, w->path, line, key);
+            continue;
+        }
+        // the command line wins over the file
+        if (f->has_seen) {
+            continue;
+        }
+
+        // strings point into the buffer of the load, so they are published every time
+        bool same     = w->prev[f->id] != NULL && !strcmp(w->prev[f->id], value);
+        w->prev[f->id] = NULL;
+        if (same && type != CFLG_VALUE_STRING) {
+            w->prev[f->id] = value;
+            continue;
+        }
+        if (!cflg_watch_parse(w, f, type, key, value)) {
+            cflg_fprintf(CFLG_STDERR, "%s: %s:%u: invalid value for '%s': '%s'\n", prog, w->path, line, key, value);
+            continue;
+        }
+        w->prev[f->id]        = value;
+        w->changed[nchanged++] = f->id;
+        ndiffer += !same;
+    }
+
+    // values of keys which are gone are kept, but the buffer they came from is reused by
+    // the next load, so strings are copied after the text of this one
+    char *tail = text + len + 1;
+    for (uint32_t id = 0; id < w->index->nflgs; ++id) {
+        const char *old = w->prev[id];
+        if (old == NULL || (old >= text && old <= text + len)) {
+            continue;
+        }
+        w->prev[id] = NULL;
+        size_t size = strlen(old) + 1;
+        if (cflg_value_type(w->index->flgs[id]) != CFLG_VALUE_STRING) {
+            continue;
+        }
+        if (size > (size_t) (text + w->cap - tail)) {
+            cflg_fprintf(CFLG_STDERR, "%s: no room left in the buffer to keep '%s'\n", prog, old);
+            continue;
+        }
+        memcpy(tail, old, size);
+        memcpy(&w->values[id], &tail, sizeof(char *));
+        w->prev[id]            = tail;
+        w->changed[nchanged++] = id;
+        tail += size;
+    }
+
+    cflg_watch_publish(w, nchanged);
+    w->gen++;
+    return (int) ndiffer;
+}
+
+bool cflg_watch_open(cflg_watch_t *w, cflg_flgset_t *fset, const char *path, char *buf, size_t cap) {
+    *w = (cflg_watch_t) {.fset = fset,
+                         .path = path,
+                         .base = cflg_find_base(path),
+                         .fd   = -1,
+                         .text = {buf, buf + cap / 2},
+                         .cap  = cap / 2};
+    const char *prog = CFLG_FALLBACK(fset->prog_name, "cflg");
+
+    // the index and the arrays per flag below, parsing is over so there is no stack
+    // fallback and fset->arena has to hold them
+    uint32_t n, nnames;
+    cflg_flgset_count(fset, &n, &nnames);
+    size_t size = cflg_flgset_size(fset, false) + CFLG_ALIGN_UP(n * sizeof(const char *)) +
+                  CFLG_ALIGN_UP(n * sizeof(uint64_t)) + CFLG_ALIGN_UP(n * sizeof(uint32_t));
+
+    // the index is only for the watcher, fset->index is reserved for generated ones
+    cflg_index_t *index = fset->index;
+    int           res   = cflg_flgset_index(fset, NULL);
+    w->index            = fset->index;
+    fset->index         = index;
+    if (res == CFLG_OK) {
+        w->prev    = cflg_arena_alloc(&fset->arena, n * sizeof(const char *));
+        w->values  = cflg_arena_alloc(&fset->arena, n * sizeof(uint64_t));
+        w->changed = cflg_arena_alloc(&fset->arena, n * sizeof(uint32_t));
+        if (w->prev == NULL || w->values == NULL || w->changed == NULL) {
+            res = CFLG_ERR_NOMEM;
+        }
+    }
+    if (res == CFLG_ERR_NOMEM) {
+        cflg_fprintf(CFLG_STDERR, "%s: not enough memory for flags, %zu bytes of arena needed\n", prog, size);
+    }
+    if (res != CFLG_OK) {
+        return false;
+    }
+    memset(w->prev, 0, n * sizeof(const char *));
+
+    // the directory is watched, editors often replace the file instead of writing it
+    char   dir[4096];
+    size_t dir_len = w->base - path;
+    if (dir_len >= sizeof(dir)) {
+        cflg_fprintf(CFLG_STDERR, "%s: path '%s' is too long\n", prog, path);
+        return false;
+    }
+    memcpy(dir, path, dir_len);
+    strcpy(dir + dir_len, dir_len ? "" : ".");
+
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (w->fd < 0 || inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        cflg_fprintf(CFLG_STDERR, "%s: cannot watch '%s'\n", prog, path);
+        cflg_watch_close(w);
+        return false;
+    }
+    if (cflg_watch_load(w) < 0) {
+        cflg_watch_close(w);
+        return false;
+    }
+    return true;
+}
+
+int cflg_watch_poll(cflg_watch_t *w, int timeout_ms) {
+    struct pollfd p   = {.fd = w->fd, .events = POLLIN};
+    int           res = poll(&p, 1, timeout_ms);
+    if (res <= 0) {
+        return res < 0 && errno != EINTR ? -1 : 0;
+    }
+
+    union {
+        struct inotify_event event;
+        char                 buf[4096];
+    } events;
+    bool    hit = false;
+    ssize_t n;
+    while ((n = read(w->fd, events.buf, sizeof(events.buf))) > 0) {
+        for (char *e = events.buf; e < events.buf + n;) {
+            struct inotify_event *event = (struct inotify_event *) e;
+            hit                         = hit || (event->len && !strcmp(event->name, w->base));
+            e += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return hit ? cflg_watch_load(w) : 0;
+}
+
+void cflg_watch_read(cflg_watch_t *w, const void *var, void *out, size_t size) {
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&w->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        memcpy(out, var, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&w->seq, __ATOMIC_RELAXED) == seq) {
+            return;
+        }
+    }
+}
+
+void cflg_watch_close(cflg_watch_t *w) {
+    if (w->fd >= 0) {
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+#endif
+
+#ifdef CFLG_FREESTANDING
+
+// value of c as a digit, 36 if it isn't one in any base
+int cflg_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    return c >= 'a' && c <= 'z' ? c - 'a' + 10 : 36;
+}
+
+// reads the magnitude and sign of an integer like strtoull does (base 0 picks 8, 10 or 16
+// from the prefix), *end is s if there are no digits. saturates at UINT64_MAX
+uint64_t cflg_scan_uint(const char *s, char **end, int base, bool *neg) {
+    const char *p = s;
+    while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+        p++;
+    }
+    *neg = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+    if ((base == 0 || base == 16) && p[0] == '0' && (p[1] | 0x20) == 'x' && cflg_digit(p[2]) < 16) {
+        p += 2, base = 16;
+    } else if (base == 0) {
+        base = p[0] == '0' ? 8 : 10;
+    }
+
+    const char *digits = p;
+    uint64_t    v      = 0;
+    bool        over   = false;
+    for (int d; (d = cflg_digit(*p)) < base; ++p) {
+        over = over || v > (UINT64_MAX - d) / base;
+        v    = v * base + d;
+    }
+    if (end) {
+        *end = (char *) (p == digits ? s : p);
+    }
+    if (over) {
+        CFLG_ERRNO = CFLG_ERANGE;
+        return UINT64_MAX;
+    }
+    return v;
+}
+
+long long cflg_strtoll(const char *s, char **end, int base) {
+    bool     neg;
+    uint64_t v = cflg_scan_uint(s, end, base, &neg);
+    if (v > (uint64_t) INT64_MAX + neg) {
+        CFLG_ERRNO = CFLG_ERANGE;
+        return neg ? INT64_MIN : INT64_MAX;
+    }
+    return neg ? (long long) (0 - v) : (long long) v;
+}
+
+unsigned long long cflg_strtoull(const char *s, char **end, int base) {
+    bool     neg;
+    uint64_t v = cflg_scan_uint(s, end, base, &neg);
+    return neg && v != UINT64_MAX ? 0 - v : v;
+}
+
+// decimal floating point numbers with an optional exponent, no hex floats, inf or nan.
+// exact with at most 15 significant digits and exponents within +-22, which covers the
+// usual flag values, a few ulps off otherwise
+double cflg_strtod(const char *s, char **end) {
+    static const double exact[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    static const double binary[] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+
+    const char *p = s;
+    while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+        p++;
+    }
+    bool neg = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p++;
+    }
+
+    // the first 19 significant digits, the rest only move the exponent
+    uint64_t m = 0;
+    int      ndigits = 0, e10 = 0;
+    bool     any = false;
+    for (; *p >= '0' && *p <= '9'; ++p, any = true) {
+        if (ndigits < 19) {
+            m = m * 10 + (*p - '0');
+            ndigits += m != 0;
+        } else {
+            e10++;
+        }
+    }
+    if (*p == '.') {
+        for (++p; *p >= '0' && *p <= '9'; ++p, any = true) {
+            if (ndigits < 19) {
+                m = m * 10 + (*p - '0');
+                ndigits += m != 0;
+                e10--;
+            }
+        }
+    }
+    if (!any) {
+        if (end) {
+            *end = (char *) s;
+        }
+        return 0;
+    }
+    if ((*p | 0x20) == 'e') {
+        const char *q      = p + 1;
+        bool        expneg = *q == '-';
+        if (*q == '-' || *q == '+') {
+            q++;
+        }
+        if (*q >= '0' && *q <= '9') {
+            int e = 0;
+            for (; *q >= '0' && *q <= '9'; ++q) {
+                e = e < 100000 ? e * 10 + (*q - '0') : e;
+            }
+            e10 += expneg ? -e : e;
+            p = q;
+        }
+    }
+    if (end) {
+        *end = (char *) p;
+    }
+
+    double v = (double) m;
+    int    e = e10 < 0 ? -e10 : e10;
+    if (m < (1ull << 53) && e <= 22) {
+        v = e10 < 0 ? v / exact[e] : v * exact[e];
+    } else if (m != 0) {
+        double f = 1;
+        for (int i = 0; i < 9 && e; ++i, e >>= 1) {
+            f *= e & 1 ? binary[i] : 1;
+        }
+        v = e ? (e10 < 0 ? 0 : DBL_MAX * 2) : (e10 < 0 ? v / f : v * f);
+    }
+    if (m != 0 && (v == 0 || v > DBL_MAX)) {
+        CFLG_ERRNO = CFLG_ERANGE;
+    }
+    return neg ? -v : v;
+}
+
+#ifndef CFLG_NO_TEXT
+
+// output of cflg_fprintf, handed to CFLG_WRITE in blocks
+typedef struct {
+    cflg_out_t out;
+    char       buf[256];
+    size_t     len;
+    int        total;
+} cflg_writer_t;
+
+void cflg_write_str(cflg_writer_t *w, const char *s, size_t n) {
+    w->total += (int) n;
+    while (n) {
+        if (w->len == sizeof(w->buf)) {
+            CFLG_WRITE(w->out, w->buf, w->len);
+            w->len = 0;
+        }
+        size_t k = sizeof(w->buf) - w->len < n ? sizeof(w->buf) - w->len : n;
+        memcpy(w->buf + w->len, s, k);
+        w->len += k, s += k, n -= k;
+    }
+}
+
+// printf for the conversions the library uses: %s, %c, %d, %u and %zu with '-', widths
+// and '.*' precisions
+int cflg_fprintf(cflg_out_t out, const char *fmt, ...) {
+    cflg_writer_t w = {.out = out};
+    va_list       ap;
+    va_start(ap, fmt);
+    for (const char *p = fmt; *p; ++p) {
+        if (*p != '%') {
+            const char *q = strchr(p, '%');
+            q             = q ? q : p + strlen(p);
+            cflg_write_str(&w, p, q - p);
+            p = q - 1;
+            continue;
+        }
 
-    for (;;) {
-        int res = cflg_flgset_parse_one(fset, argc, argv, &ctx, &curr_index);
-        if (res == CFLG_PARSE_FINISH) {
+        bool left = *++p == '-';
+        int  width = 0, prec = -1;
+        p += left;
+        if (*p == '*') {
+            width = va_arg(ap, int), p++;
+        }
+        for (; *p >= '0' && *p <= '9'; ++p) {
+            width = width * 10 + (*p - '0');
+        }
+        if (p[0] == '.' && p[1] == '*') {
+            prec = va_arg(ap, int), p += 2;
+        }
+        bool is_size = *p == 'z';
+        p += is_size;
+
+        char        num[24];
+        const char *str = num;
+        size_t      n   = 1;
+        uint64_t    v   = 0;
+        bool        neg = false;
+        switch (*p) {
+        case 's':
+            str = va_arg(ap, const char *);
+            str = str ? str : "(null)";
+            if (prec >= 0) {
+                const char *nul = memchr(str, '\0', prec);
+                n               = nul ? (size_t) (nul - str) : (size_t) prec;
+            } else {
+                n = strlen(str);
+            }
+            break;
+        case 'c':
+            num[0] = (char) va_arg(ap, int);
+            break;
+        case 'd': {
+            int d = va_arg(ap, int);
+            neg   = d < 0;
+            v     = neg ? 0 - (uint64_t) d : (uint64_t) d;
+        } break;
+        case 'u':
+            v = is_size ? va_arg(ap, size_t) : va_arg(ap, unsigned int);
+            break;
+        default: // '%', or one the library doesn't use
+            num[0] = *p ? *p : '%';
+            p -= *p == '\0';
             break;
         }
-        // if it was a non flag
-        if (res == CFLG_PARSE_NONFLG) {
-            cflg_swap_args(argv, curr_index, ++last_nonopt);
-            continue;
+        if (*p == 'd' || *p == 'u') {
+            char *d = num + sizeof(num);
+            do {
+                *--d = (char) ('0' + v % 10);
+            } while (v /= 10);
+            if (neg) {
+                *--d = '-';
+            }
+            str = d, n = num + sizeof(num) - d;
         }
-        // if there was an error
-        if (res != CFLG_OK && res != CFLG_OK_NO_ARG) {
-            cflg_print_err(res, fset, &ctx);
-            exit(1);
+
+        for (int pad = width - (int) n; !left && pad > 0; --pad) {
+            cflg_write_str(&w, " ", 1);
         }
-        // if help was requested
-        if (is_help) {
-            fset->usage(fset);
-            is_help = false;
-            exit(0);
+        cflg_write_str(&w, str, n);
+        for (int pad = width - (int) n; left && pad > 0; --pad) {
+            cflg_write_str(&w, " ", 1);
         }
     }
-
-    for (curr_index = curr_index + 1; curr_index < argc; ++curr_index) {
-        cflg_swap_args(argv, curr_index, ++last_nonopt);
+    va_end(ap);
+    if (w.len) {
+        CFLG_WRITE(w.out, w.buf, w.len);
     }
+    return w.total;
+}
 
-    // remove help flag, because after returning from this function
-    // it will be deallocated
-    fset->flgs   = fset->flgs->next;
-
-    fset->narg   = last_nonopt + 1;
-    fset->parsed = true;
+#endif // CFLG_NO_TEXT
 
-    // return the number of processed arguments
-    return argc - fset->narg;
-}
+#endif // CFLG_FREESTANDING
 
 int cflg_parse_bool(cflg_parser_context_t *ctx) {
+    // --no-<name> and --<name>=true|false set the value, a plain flag flips it once
+    if (ctx->is_negated) {
+        if (ctx->is_arg_forced) {
+            return CFLG_ERR_ARG_FORCED;
+        }
+        *(bool *) ctx->dest = false;
+        return CFLG_OK_NO_ARG;
+    }
+    if (ctx->is_arg_forced) {
+        if (ctx->arg == NULL) {
+            return CFLG_ERR_ARG_NEEDED;
+        }
+        if (strcmp(ctx->arg, "true") && strcmp(ctx->arg, "false")) {
+            return CFLG_ERR_ARG_INVALID;
+        }
+        *(bool *) ctx->dest = ctx->arg[0] == 't';
+        return CFLG_OK;
+    }
     if (!ctx->has_been_parsed) {
         *(bool *) ctx->dest = !(*(bool *) ctx->dest);
     }
@@ -691,7 +3765,7 @@ int cflg_parse_int(cflg_parser_context_t *ctx) {
         return CFLG_ERR_ARG_NEEDED;
     }
     char *endptr;
-    int   n = strtol(ctx->arg, &endptr, 0);
+    int   n = cflg_strtol(ctx->arg, &endptr, 0);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -706,7 +3780,7 @@ int cflg_parse_uint(cflg_parser_context_t *ctx) {
         return CFLG_ERR_ARG_NEEDED;
     }
     char        *endptr;
-    unsigned int n = strtoul(ctx->arg, &endptr, 0);
+    unsigned int n = cflg_strtoul(ctx->arg, &endptr, 0);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -722,7 +3796,7 @@ int cflg_parse_int64(cflg_parser_context_t *ctx) {
     }
 
     char   *endptr;
-    int64_t n = strtoll(ctx->arg, &endptr, 0);
+    int64_t n = cflg_strtoll(ctx->arg, &endptr, 0);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -737,7 +3811,7 @@ int cflg_parse_uint64(cflg_parser_context_t *ctx) {
         return CFLG_ERR_ARG_NEEDED;
     }
     char    *endptr;
-    uint64_t n = strtoull(ctx->arg, &endptr, 0);
+    uint64_t n = cflg_strtoull(ctx->arg, &endptr, 0);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -752,7 +3826,7 @@ int cflg_parse_float(cflg_parser_context_t *ctx) {
         return CFLG_ERR_ARG_NEEDED;
     }
     char *endptr;
-    float n = strtof(ctx->arg, &endptr);
+    float n = cflg_strtof(ctx->arg, &endptr);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -767,7 +3841,7 @@ int cflg_parse_double(cflg_parser_context_t *ctx) {
         return CFLG_ERR_ARG_NEEDED;
     }
     char  *endptr;
-    double n = strtod(ctx->arg, &endptr);
+    double n = cflg_strtod(ctx->arg, &endptr);
     if (*endptr != '\0') {
         return CFLG_ERR_ARG_INVALID;
     }
@@ -785,6 +3859,494 @@ int cflg_parse_string(cflg_parser_context_t *ctx) {
     return CFLG_OK;
 }
 
+// returns the index of the choice matching arg exactly or as a unique prefix, -1 otherwise
+int cflg_enum_find(cflg_enum_t *e, const char *arg) {
+    size_t len = strlen(arg);
+    if (e->table) {
+        uint32_t i = e->table[cflg_hash(arg, len, e->seed) & e->mask];
+        if (i && !strcmp(e->choices[i - 1], arg)) {
+            return i - 1;
+        }
+    }
+
+    // unique prefix, exact matches are only found here if the table couldn't be built
+    int  found     = -1;
+    bool ambiguous = false;
+    for (int i = 0; e->choices[i]; ++i) {
+        if (strncmp(e->choices[i], arg, len)) {
+            continue;
+        }
+        if (e->choices[i][len] == '\0') {
+            return i;
+        }
+        if (found >= 0) {
+            ambiguous = true;
+        }
+        found = i;
+    }
+    return ambiguous ? -1 : found;
+}
+
+int cflg_parse_enum(cflg_parser_context_t *ctx) {
+    if (ctx->arg == NULL) {
+        return CFLG_ERR_ARG_NEEDED;
+    }
+    cflg_enum_t *e = ctx->dest;
+    int          i = cflg_enum_find(e, ctx->arg);
+    if (i < 0) {
+        return CFLG_ERR_ARG_INVALID;
+    }
+
+    *e->dest = i;
+
+    return CFLG_OK;
+}
+
+int cflg_parse_lazy(cflg_parser_context_t *ctx) {
+    if (ctx->arg == NULL) {
+        return CFLG_ERR_ARG_NEEDED;
+    }
+    cflg_lazy_t *l = ctx->dest;
+
+    // argv outlives parsing, so the context can be replayed later
+    l->ctx                 = *ctx;
+    l->ctx.dest            = l->dest;
+    l->ctx.has_been_parsed = false;
+    l->pending             = true;
+    return CFLG_OK;
+}
+
+// stores n consecutive integers from lo at items[at..), as far as room allows
+void cflg_array_put_range(uint32_t type, void *items, uint64_t at, uint64_t room, int64_t lo, uint64_t n) {
+    for (uint64_t i = 0; i < n && at + i < room; ++i) {
+        int64_t v = lo + (int64_t) i;
+        if (type == CFLG_ARRAY_INT) {
+            ((int *) items)[at + i] = (int) v;
+        } else {
+            ((int64_t *) items)[at + i] = v;
+        }
+    }
+}
+
+// converts the values of arg[0..len) separated by delim, storing the first room of them
+// at items if it isn't NULL. values are found with memchr, which libc vectorises, and
+// converted in place since strto* stop at the delimiter. returns the number of values
+// in arg (a range counts all of its values), or -1 if one of them is invalid
+int64_t cflg_array_scan(uint32_t type, char delim, const char *arg, size_t len, void *items, uint64_t room) {
+    const char *end   = arg + len;
+    uint64_t    total = 0;
+    for (const char *p = arg; p <= end; ++p) {
+        const char *next = memchr(p, delim, end - p);
+        next             = next ? next : end;
+        if (p == next || *p == ' ' || *p == '\t' || *p == '\n') {
+            return -1;
+        }
+
+        char *stop;
+        CFLG_ERRNO = 0;
+        if (type == CFLG_ARRAY_DOUBLE) {
+            double v = cflg_strtod(p, &stop);
+            if (stop != next) {
+                return -1;
+            }
+            if (items && total < room) {
+                ((double *) items)[total] = v;
+            }
+            total++, p = next;
+            continue;
+        }
+
+        // lo or lo-hi, where lo may be negative
+        int64_t lo = cflg_strtoll(p, &stop, 0), hi = lo;
+        if (stop < next && *stop == '-') {
+            const char *h = stop + 1;
+            hi            = cflg_strtoll(h, &stop, 0);
+            if (stop == h) {
+                return -1;
+            }
+        }
+        bool narrow = type == CFLG_ARRAY_INT && (lo < INT_MIN || hi > INT_MAX);
+        if (stop != next || CFLG_ERRNO == CFLG_ERANGE || narrow || lo > hi) {
+            return -1;
+        }
+        uint64_t n = (uint64_t) hi - (uint64_t) lo + 1;
+        if (items && total < room) {
+            cflg_array_put_range(type, items, total, room, lo, n);
+        }
+        total = n == 0 || total + n < total ? UINT64_MAX : total + n; // 0 is all 2^64 values
+        p     = next;
+    }
+    return total > INT64_MAX ? INT64_MAX : (int64_t) total;
+}
+
+int cflg_parse_array(cflg_parser_context_t *ctx, uint32_t type) {
+    if (ctx->arg == NULL) {
+        return CFLG_ERR_ARG_NEEDED;
+    }
+    cflg_array_t *a     = ctx->dest;
+    size_t        size  = cflg_array_sizes[type];
+    size_t        len   = strlen(ctx->arg);
+    char          delim = a->delim ? a->delim : ',';
+
+    // with an arena, the values are counted first and items moves to a block at least twice
+    // as large when they don't fit, so k occurrences copy O(k) elements in total
+    uint64_t room  = a->cap - a->count;
+    void    *items = a->items;
+    if (a->arena != NULL || a->items == NULL) {
+        if (a->arena == NULL) {
+            return CFLG_ERR_NOMEM;
+        }
+        int64_t n = cflg_array_scan(type, delim, ctx->arg, len, NULL, 0);
+        if (n < 0) {
+            return CFLG_ERR_ARG_INVALID;
+        }
+        // a short range may stand for billions of values, only so many are expanded
+        uint64_t max  = a->cap ? a->cap : CFLG_ARRAY_MAX;
+        room          = (uint64_t) n < max - a->count ? (uint64_t) n : max - a->count;
+        uint64_t need = a->count + room;
+        if (need > a->alloc) {
+            uint64_t alloc = 2 * (uint64_t) a->alloc > need ? 2 * (uint64_t) a->alloc : need;
+            alloc          = alloc < 8 ? 8 : alloc > max ? max : alloc;
+            items          = alloc <= SIZE_MAX / size ? cflg_arena_alloc(a->arena, alloc * size) : NULL;
+            if (items == NULL) {
+                return CFLG_ERR_NOMEM;
+            }
+            if (a->count) {
+                memcpy(items, a->items, a->count * size);
+            }
+            a->alloc = (uint32_t) alloc;
+        }
+    }
+
+    int64_t n = cflg_array_scan(type, delim, ctx->arg, len, (char *) items + a->count * size, room);
+    if (n < 0) {
+        return CFLG_ERR_ARG_INVALID;
+    }
+    a->items    = items;
+    a->overflow = a->overflow || (uint64_t) n > room;
+    a->count += (uint32_t) ((uint64_t) n < room ? (uint64_t) n : room);
+    return CFLG_OK;
+}
+
+int cflg_parse_int_array(cflg_parser_context_t *ctx) {
+    return cflg_parse_array(ctx, CFLG_ARRAY_INT);
+}
+
+int cflg_parse_int64_array(cflg_parser_context_t *ctx) {
+    return cflg_parse_array(ctx, CFLG_ARRAY_INT64);
+}
+
+int cflg_parse_double_array(cflg_parser_context_t *ctx) {
+    return cflg_parse_array(ctx, CFLG_ARRAY_DOUBLE);
+}
+
+// returns the slot of key[0..len) in map, or the empty slot where it belongs
+cflg_map_entry_t *cflg_map_slot(cflg_map_t *map, const char *key, uint32_t len) {
+    uint32_t i = cflg_hash(key, len, 0) & map->mask;
+    for (;; i = (i + 1) & map->mask) {
+        cflg_map_entry_t *e = &map->slots[i];
+        if (e->key == NULL || (e->key_len == len && !memcmp(e->key, key, len))) {
+            return e;
+        }
+    }
+}
+
+cflg_map_entry_t *cflg_map_find(cflg_map_t *map, const char *key, size_t len) {
+    if (map->slots == NULL || len > UINT32_MAX) {
+        return NULL;
+    }
+    cflg_map_entry_t *e = cflg_map_slot(map, key, (uint32_t) len);
+    return e->key ? e : NULL;
+}
+
+const char *cflg_map_get(cflg_map_t *map, const char *key) {
+    cflg_map_entry_t *e = cflg_map_find(map, key, strlen(key));
+    return e ? e->value : NULL;
+}
+
+int cflg_parse_map(cflg_parser_context_t *ctx) {
+    if (ctx->arg == NULL) {
+        return CFLG_ERR_ARG_NEEDED;
+    }
+    cflg_map_t *map = ctx->dest;
+    const char *eq  = strchr(ctx->arg, '=');
+    size_t      len = eq ? (size_t) (eq - ctx->arg) : strlen(ctx->arg);
+    if (len == 0 || len > UINT32_MAX || map->slots == NULL) {
+        return CFLG_ERR_ARG_INVALID;
+    }
+
+    cflg_map_entry_t *e = cflg_map_slot(map, ctx->arg, (uint32_t) len);
+    if (e->key != NULL) {
+        if (map->unique) {
+            return CFLG_ERR_ARG_INVALID;
+        }
+        e->value = eq ? eq + 1 : NULL;
+        return CFLG_OK;
+    }
+    // keeping a quarter of the slots empty bounds the probe sequences
+    if (map->count + 1 > (map->mask + 1ull) * 3 / 4) {
+        return CFLG_ERR_ARG_INVALID;
+    }
+    *e = (cflg_map_entry_t) {.key = ctx->arg, .key_len = (uint32_t) len, .value = eq ? eq + 1 : NULL};
+    map->count++;
+    return CFLG_OK;
+}
+
+void *cflg_lazy_get(cflg_flgset_t *fset, cflg_flg_t *flg) {
+    cflg_lazy_t *l = flg->dest;
+    if (l->pending) {
+        l->pending = false;
+        int res    = l->parser(&l->ctx);
+        if (res != CFLG_OK && res != CFLG_OK_NO_ARG) {
+            cflg_print_err(res, fset, &l->ctx);
+#ifdef CFLG_FREESTANDING
+            return NULL;
+#else
+            exit(1);
+#endif
+        }
+    }
+    return l->dest;
+}
+
+void cflg_iter_init(cflg_iter_t *it, cflg_flgset_t *fset, int argc, char *const argv[]) {
+#ifndef PROGRAM_NAME
+    if (fset->prog_name == NULL)
+        fset->prog_name = cflg_find_base(argv[0]);
+#else
+    fset->prog_name = PROGRAM_NAME;
+#endif
+
+    *it = (cflg_iter_t) {.fset = fset, .index = fset->index, .argc = argc, .argv = argv};
+    if (it->index != NULL) {
+        return;
+    }
+
+    // the index is kept by the iterator, fset->index is only set by a generated index,
+    // which cflg_flgset_parse must still be able to tell apart
+    int res     = cflg_flgset_index(fset, NULL);
+    it->index   = fset->index;
+    fset->index = NULL;
+    if (res == CFLG_ERR_NOMEM) {
+        cflg_fprintf(CFLG_STDERR, "%s: not enough memory for flags, %zu bytes of arena needed\n", fset->prog_name,
+                     cflg_flgset_size(fset, false));
+    }
+    if (res != CFLG_OK) {
+#ifdef CFLG_FREESTANDING
+        // cflg_next reports the end of argv right away
+        it->index = NULL;
+#else
+        exit(1);
+#endif
+    }
+}
+
+bool cflg_next(cflg_iter_t *it, cflg_event_t *ev) {
+    if (it->index == NULL) {
+        return false;
+    }
+    if (it->has_value) {
+        it->has_value = false;
+        *ev           = it->value;
+        return true;
+    }
+
+    const char *arg = NULL;
+    *ev             = (cflg_event_t) {.kind = CFLG_EVENT_FLAG, .index = it->curr_index};
+
+    // next option of a group of short options
+    if (!CFLG_ISEMPTY(it->shorts)) {
+        ev->opt          = it->shorts;
+        ev->opt_len      = 1;
+        ev->is_opt_short = true;
+        it->shorts       = ev->opt + 1;
+    } else {
+        if (++it->curr_index >= it->argc) {
+            it->curr_index = it->argc;
+            return false;
+        }
+        ev->index        = it->curr_index;
+        const char *curr = it->argv[it->curr_index];
+
+        if (it->no_flags || CFLG_IS_NONFLG(curr)) {
+            it->no_flags = it->no_flags || it->fset->posix;
+            ev->kind     = CFLG_EVENT_POSITIONAL;
+            ev->arg      = curr;
+            return true;
+        }
+
+        // special argv element '--' means forced end of options
+        if (curr[1] == '-' && curr[2] == '\0') {
+            it->no_flags = true;
+            return cflg_next(it, ev);
+        }
+
+        if (curr[1] != '-') {
+            ev->opt          = curr + 1;
+            ev->opt_len      = 1;
+            ev->is_opt_short = true;
+            it->shorts       = ev->opt + 1;
+        } else {
+            ev->opt = curr + 2;
+            arg     = strchr(ev->opt, '=');
+            if (arg) {
+                ev->opt_len = arg++ - ev->opt;
+            } else {
+                ev->opt_len = strlen(ev->opt);
+            }
+        }
+    }
+
+    int res = CFLG_OK;
+    if (ev->is_opt_short) {
+        ev->flg = cflg_index_find_short(it->index, *ev->opt);
+    } else {
+        res = cflg_index_resolve(it->index, ev->opt, ev->opt_len, &ev->flg, &ev->negated);
+    }
+    // a generated index keeps a slot for --help, which only cflg_flgset_parse defines
+    if (res == CFLG_OK && ev->flg == NULL) {
+        res = CFLG_ERR_OPT_INVALID;
+    }
+
+    // bool flags take an optional value, as in --verbose=false
+    bool optional = res == CFLG_OK && ev->flg->negatable && !ev->negated && arg != NULL;
+    if (res == CFLG_OK && (ev->flg->arg_name != NULL || optional)) {
+        // the rest of a short option group (e.g. -ofile) or the next argv element
+        if (ev->is_opt_short && !CFLG_ISEMPTY(it->shorts)) {
+            arg        = it->shorts;
+            it->shorts = NULL;
+        } else if (arg == NULL && it->curr_index + 1 < it->argc) {
+            arg = it->argv[++it->curr_index];
+        }
+        if (CFLG_ISEMPTY(arg)) {
+            res = CFLG_ERR_ARG_NEEDED;
+        } else {
+            it->value     = (cflg_event_t) {.kind         = CFLG_EVENT_VALUE,
+                                            .flg          = ev->flg,
+                                            .opt          = ev->opt,
+                                            .opt_len      = ev->opt_len,
+                                            .is_opt_short = ev->is_opt_short,
+                                            .arg          = arg,
+                                            .index        = it->curr_index};
+            it->has_value = true;
+        }
+    } else if (res == CFLG_OK && arg != NULL) {
+        res = CFLG_ERR_ARG_FORCED;
+    }
+
+    if (res != CFLG_OK) {
+        // the rest of the argv element can't be trusted
+        it->shorts = NULL;
+        ev->kind   = CFLG_EVENT_ERROR;
+        ev->err    = res;
+        ev->arg    = arg;
+    }
+    return true;
+}
+
+// cflg_flgset_peek once fset has an arena
+int cflg_flgset_peek_(cflg_flgset_t *fset, int argc, char *const argv[]) {
+    cflg_iter_t  it;
+    cflg_event_t ev;
+    int          found = 0;
+    cflg_iter_init(&it, fset, argc, argv);
+    while (found >= 0 && cflg_next(&it, &ev)) {
+        // options of other flags are left to the full parse, errors of ours are returned
+        if (ev.kind == CFLG_EVENT_ERROR && ev.flg != NULL) {
+            found = ev.err;
+        }
+        if (ev.kind != CFLG_EVENT_FLAG) {
+            continue;
+        }
+
+        cflg_flg_t           *f   = ev.flg;
+        cflg_parser_context_t ctx = {.opt             = ev.opt,
+                                     .opt_len         = ev.opt_len,
+                                     .is_opt_short    = ev.is_opt_short,
+                                     .is_negated      = ev.negated,
+                                     .has_been_parsed = f->has_seen,
+                                     .dest            = f->dest,
+                                     .flg             = f};
+        if (it.has_value) {
+            int opt_index = ev.index;
+            cflg_next(&it, &ev);
+            ctx.arg = ev.arg;
+            // --name=value, as opposed to --name value or -ovalue
+            ctx.is_arg_forced = !ctx.is_opt_short && ev.index == opt_index;
+        }
+
+        int res = f->parser(&ctx);
+        if (res == CFLG_OK_NO_ARG && ctx.is_arg_forced) {
+            res = CFLG_ERR_ARG_FORCED;
+        }
+        f->has_seen = true;
+        found       = res == CFLG_OK || res == CFLG_OK_NO_ARG ? found + 1 : res;
+    }
+    return found;
+}
+
+// cflg_flgset_peek_ with a stack buffer as the arena, see cflg_flgset_run_on_stack
+int cflg_flgset_peek_on_stack(cflg_flgset_t *fset, int argc, char *const argv[]) {
+    uint64_t stack_mem[CFLG_STACK_ARENA_SIZE / sizeof(uint64_t)];
+    fset->arena = (cflg_arena_t) {.base = (unsigned char *) stack_mem, .cap = sizeof(stack_mem)};
+    int found   = cflg_flgset_peek_(fset, argc, argv);
+    fset->arena = (cflg_arena_t) {0};
+    return found;
+}
+
+int cflg_flgset_peek(cflg_flgset_t *fset, int argc, char *const argv[]) {
+    // the index is only needed for this pass, see cflg_flgset_run
+    if (fset->arena.base == NULL && fset->arena.grow == NULL) {
+        return cflg_flgset_peek_on_stack(fset, argc, argv);
+    }
+    return cflg_flgset_peek_(fset, argc, argv);
+}
+
+void cflg_iter_print_err(cflg_iter_t *it, const cflg_event_t *ev) {
+    cflg_parser_context_t ctx = {.opt          = ev->opt,
+                                 .opt_len      = ev->opt_len,
+                                 .is_opt_short = ev->is_opt_short,
+                                 .arg          = ev->arg,
+                                 .flg          = ev->flg};
+
+    // ambiguous options are listed from the index
+    cflg_index_t *idx = it->fset->index;
+    it->fset->index   = it->index;
+    cflg_print_err(ev->err, it->fset, &ctx);
+    it->fset->index = idx;
+}
+
+bool cflg_flgset_link(cflg_flgset_t *child, cflg_flgset_t *parent) {
+    if (parent->shared == NULL && parent->index != NULL) {
+        // a generated index, its slot for --help stays empty
+        parent->shared         = parent->index;
+        parent->shared->parent = parent->parent ? parent->parent->shared : NULL;
+    } else if (parent->shared == NULL) {
+        // the index is kept in shared, fset->index would be taken for a generated one
+        int           res  = cflg_flgset_index(parent, NULL);
+        cflg_index_t *idx  = parent->index;
+        parent->index      = NULL;
+        const char   *prog = CFLG_FALLBACK(child->prog_name, CFLG_FALLBACK(parent->prog_name, "cflg"));
+        if (res == CFLG_ERR_NOMEM && parent->arena.base == NULL && parent->arena.grow == NULL) {
+            cflg_fprintf(CFLG_STDERR, "%s: a linked flag set needs an arena, %zu bytes\n", prog,
+                         cflg_flgset_size(parent, false));
+        } else if (res == CFLG_ERR_NOMEM) {
+            cflg_fprintf(CFLG_STDERR, "%s: not enough memory for flags, %zu bytes of arena needed\n", prog,
+                         cflg_flgset_size(parent, false));
+        }
+        if (res != CFLG_OK) {
+            return false;
+        }
+        parent->shared = idx;
+    }
+
+    bool ok = cflg_link_check(child, parent->shared, NULL);
+    if (ok) {
+        child->parent = parent;
+    }
+    return ok;
+}
+
 // Helper function which converts c to lower case if it's uppercase
 // otherwise returns c itself 
 int cflg_tolower(int c) {
@@ -832,46 +4394,86 @@ int cflg_cmp_flgs(cflg_flg_t *a, cflg_flg_t *b) {
     return 0; // Flags are identical(this is bad)
 }
 
-// sorts flag list lexicographically and updates the head 
+// sorts flag list lexicographically and updates the head. bottom-up merge sort, so it's
+// O(n log n) comparisons in any order of definition and needs no memory
 void cflg_sort_flags(cflg_flg_t **flg_head) {
-    // this function sorts flags using insertion sort
-    
-    // create a dummy flag node to avoid edge cases of changing the head
-    cflg_flg_t *dummy = &(cflg_flg_t) {.next = *flg_head},
-    // prev always points to the end of the sorted list
-               *prev  = *flg_head,
-    // curr always points to the start of the unsorted list
-               *curr  = (*flg_head)->next;
-
-    while (curr) {
-        // if current is already in the correct location 
-        if (cflg_cmp_flgs(curr,prev) > 0) {
-            prev = curr;
-            curr = curr->next;
-            continue;
+    for (size_t width = 1;; width *= 2) {
+        cflg_flg_t  *rest   = *flg_head;
+        cflg_flg_t **tail   = flg_head;
+        size_t       nmerge = 0;
+
+        // merge every pair of adjacent runs of width flags
+        while (rest) {
+            cflg_flg_t *a = rest, *b = rest;
+            size_t      na = 0, nb = width;
+            while (b && na < width) {
+                b = b->next;
+                na++;
+            }
+            while (na > 0 || (nb > 0 && b)) {
+                cflg_flg_t *take;
+                if (na == 0 || (nb > 0 && b && cflg_cmp_flgs(b, a) < 0)) {
+                    take = b, b = b->next, nb--;
+                } else {
+                    take = a, a = a->next, na--;
+                }
+                *tail = take;
+                tail  = &take->next;
+            }
+            rest = b;
+            nmerge++;
+        }
+        *tail = NULL;
+
+        if (nmerge <= 1) {
+            return;
         }
+    }
+}
+
+// prints the choices of an enum flag starting with arg, or all of them if none does
+void cflg_print_choices(cflg_out_t out, cflg_enum_t *e, const char *arg) {
+#ifdef CFLG_NO_TEXT
+    (void) out, (void) e, (void) arg;
+#else
+    size_t len = CFLG_STRLEN(arg);
+    bool   any = false;
+    for (int i = 0; e->choices[i] && len; ++i) {
+        any = any || !strncmp(e->choices[i], arg, len);
+    }
 
-        // otherwise find its correct location
-        cflg_flg_t *tmp = dummy;
-        while(cflg_cmp_flgs(curr, tmp->next) > 0) {
-                tmp = tmp->next;
+    cflg_fprintf(out, any ? "; possibilities:" : "; valid arguments:");
+    for (int i = 0; e->choices[i]; ++i) {
+        if (!any || !strncmp(e->choices[i], arg, len)) {
+            cflg_fprintf(out, " '%s'", e->choices[i]);
         }
-        
-        prev->next = curr->next;
-        curr->next = tmp->next;
-        tmp->next  = curr;
-        curr = prev->next;
     }
+#endif
+}
 
-    // update the head to the new head
-    *flg_head = dummy->next;
+// width of the names and the argument of a flag, excluding the primary short option
+int cflg_flg_width(cflg_flg_t *f) {
+    int width = CFLG_STRLEN(f->name_long) + CFLG_STRLEN(f->arg_name);
+    // each alias adds "-a, " or ", --alias"
+    CFLG_FOREACH_ALIAS(a, f) {
+        if (a->name) {
+            width += 4;
+        }
+        if (!CFLG_ISEMPTY(a->name_long)) {
+            width += 4 + strlen(a->name_long);
+        }
+    }
+    return width;
 }
 
-void cflg_print_flags(cflg_flg_t *flags) {
+void cflg_fprint_flags(cflg_out_t out, cflg_flg_t *flags) {
+#ifdef CFLG_NO_TEXT
+    (void) out, (void) flags;
+#else
     // find the maximum length
     int max_width = 0;
     CFLG_FOREACH(i, flags) {
-        int curr_len = CFLG_STRLEN(i->name_long) + CFLG_STRLEN(i->arg_name);
+        int curr_len = cflg_flg_width(i);
         if (curr_len > max_width) {
             max_width = curr_len;
         }
@@ -885,50 +4487,87 @@ void cflg_print_flags(cflg_flg_t *flags) {
         // [1] name, name_long=<arg_name> usage
         // [2] name  <arg_name>           usage
         // [3]       name_long=<arg_name> usage
-        current_len += printf("  ");
+        // aliases are printed next to names of the same kind (e.g. -v, -V, --verbose, --talkative)
+        current_len += cflg_fprintf(out, "  ");
 
+        int nshort = 0;
         if (f->name) {
-            current_len += printf("-%c", f->name);
-        } else {
-            current_len += printf("  ");
+            current_len += cflg_fprintf(out, "-%c", f->name);
+            nshort++;
+        }
+        CFLG_FOREACH_ALIAS(a, f) {
+            if (a->name) {
+                current_len += cflg_fprintf(out, nshort++ ? ", -%c" : "-%c", a->name);
+            }
+        }
+        if (!nshort) {
+            current_len += cflg_fprintf(out, "  ");
+        }
+
+        bool has_long = !CFLG_ISEMPTY(f->name_long);
+        CFLG_FOREACH_ALIAS(a, f) {
+            has_long = has_long || !CFLG_ISEMPTY(a->name_long);
         }
 
-        if (f->name && !CFLG_ISEMPTY(f->name_long)) {
-            current_len += printf(",");
+        if (nshort && has_long) {
+            current_len += cflg_fprintf(out, ",");
         } else {
-            current_len += printf(" ");
+            current_len += cflg_fprintf(out, " ");
         }
 
+        int nlong = 0;
         if (!CFLG_ISEMPTY(f->name_long)) {
-            current_len += printf(" --%s", f->name_long);
+            current_len += cflg_fprintf(out, " --%s", f->name_long);
+            nlong++;
+        }
+        CFLG_FOREACH_ALIAS(a, f) {
+            if (!CFLG_ISEMPTY(a->name_long)) {
+                current_len += cflg_fprintf(out, nlong++ ? ", --%s" : " --%s", a->name_long);
+            }
         }
 
         if (!CFLG_ISEMPTY(f->arg_name)) {
-            if (!CFLG_ISEMPTY(f->name_long)) {
-                current_len += printf("=");
+            if (has_long) {
+                current_len += cflg_fprintf(out, "=");
             }
-            current_len += printf("%s", f->arg_name);
+            current_len += cflg_fprintf(out, "%s", f->arg_name);
         }
 
         if (max_width > current_len) {
-            printf("%*s", max_width - current_len, "");
+            cflg_fprintf(out, "%*s", max_width - current_len, "");
         }
 
         if (!CFLG_ISEMPTY(f->usage)) {
-            printf("%s", f->usage);
+            cflg_fprintf(out, "%s", f->usage);
+        }
+        if (f->parser == cflg_parse_enum) {
+            cflg_enum_t *e = f->dest;
+            cflg_fprintf(out, CFLG_ISEMPTY(f->usage) ? "(choices: %s" : " (choices: %s", e->choices[0]);
+            for (int i = 1; e->choices[i]; ++i) {
+                cflg_fprintf(out, ", %s", e->choices[i]);
+            }
+            cflg_fprintf(out, ")");
         }
-        printf("\n");
+        cflg_fprintf(out, "\n");
     }
+#endif
+}
+
+void cflg_print_flags(cflg_flg_t *flags) {
+    cflg_fprint_flags(CFLG_STDOUT, flags);
 }
 
 void cflg_print_err(int err_code, cflg_flgset_t *fs, cflg_parser_context_t *ctx) {
+#ifdef CFLG_NO_TEXT
+    (void) err_code, (void) fs, (void) ctx;
+#else
 
     // TODO: gnu seems to print different error message
     // base on short or long format is it really
     // necessary in this library?
     //
     //
-    fprintf(stderr, "%s: ", fs->prog_name);
+    cflg_fprintf(CFLG_STDERR, "%s: ", fs->prog_name);
 
     const char *invalid_opt_err, *invalid_arg_err, *need_arg_err, *forced_arg_err, *ambiguous_opt_err;
     if (ctx->is_opt_short) {
@@ -946,37 +4585,74 @@ void cflg_print_err(int err_code, cflg_flgset_t *fs, cflg_parser_context_t *ctx)
     switch (err_code) {
 
     case CFLG_ERR_OPT_INVALID:
-        fprintf(stderr, invalid_opt_err, ctx->opt_len, ctx->opt);
+        cflg_fprintf(CFLG_STDERR, invalid_opt_err, ctx->opt_len, ctx->opt);
         break;
 
     case CFLG_ERR_ARG_INVALID:
-        fprintf(stderr, invalid_arg_err, ctx->opt_len, ctx->opt, ctx->arg);
+        cflg_fprintf(CFLG_STDERR, invalid_arg_err, ctx->opt_len, ctx->opt, ctx->arg);
+        if (ctx->flg && ctx->flg->parser == cflg_parse_enum) {
+            cflg_print_choices(CFLG_STDERR, ctx->flg->dest, ctx->arg);
+        }
         break;
 
     case CFLG_ERR_ARG_NEEDED:
-        fprintf(stderr, need_arg_err, ctx->opt_len, ctx->opt);
+        cflg_fprintf(CFLG_STDERR, need_arg_err, ctx->opt_len, ctx->opt);
         break;
 
     case CFLG_ERR_ARG_FORCED:
-        fprintf(stderr, forced_arg_err, ctx->opt_len, ctx->opt);
+        cflg_fprintf(CFLG_STDERR, forced_arg_err, ctx->opt_len, ctx->opt);
         break;
 
-    case CFLG_ERR_OPT_AMBIGUOUS:
-        fprintf(stderr, ambiguous_opt_err, ctx->opt_len, ctx->opt);
+    case CFLG_ERR_NOMEM:
+        cflg_fprintf(CFLG_STDERR, "not enough memory for the values of %s%.*s", ctx->is_opt_short ? "-" : "--",
+                     ctx->opt_len, ctx->opt);
+        break;
 
-        // find and print all matching options
-        fprintf(stderr, " possibilities:");
-        CFLG_FOREACH(item, fs->flgs) {
-            if (ctx->opt_len < CFLG_STRLEN(item->name_long) && !CFLG_STRNCMP(item->name_long, ctx->opt, ctx->opt_len)) {
-                fprintf(stderr, " '--%s'", item->name_long);
+    case CFLG_ERR_OPT_AMBIGUOUS:
+        cflg_fprintf(CFLG_STDERR, ambiguous_opt_err, ctx->opt_len, ctx->opt);
+
+        // print the matching options, at most CFLG_MAX_CANDIDATES of them, so a short
+        // prefix costs the same with any number of flags
+        cflg_fprintf(CFLG_STDERR, " possibilities:");
+        uint32_t lo, hi, nprinted = 0, nfound = 0;
+        for (cflg_index_t *idx = fs->index; idx != NULL; idx = idx->parent) {
+            // flags without an index are listed in the order they were defined
+            CFLG_FOREACH(f, idx->list) {
+                bool match = cflg_name_match(f->name_long, ctx->opt, ctx->opt_len, idx->fold) != 0;
+                if (match && nprinted < CFLG_MAX_CANDIDATES) {
+                    cflg_fprintf(CFLG_STDERR, " '--%s'", f->name_long);
+                    nprinted++;
+                }
+                CFLG_FOREACH_ALIAS(a, f) {
+                    bool alias_match = cflg_name_match(a->name_long, ctx->opt, ctx->opt_len, idx->fold) != 0;
+                    if (alias_match && nprinted < CFLG_MAX_CANDIDATES) {
+                        cflg_fprintf(CFLG_STDERR, " '--%s'", a->name_long);
+                        nprinted++;
+                    }
+                    nfound += alias_match;
+                }
+                nfound += match;
             }
+            if (idx->list != NULL) {
+                continue;
+            }
+            cflg_index_range(idx, ctx->opt, ctx->opt_len, &lo, &hi);
+            for (uint32_t i = lo; i < hi && nprinted < CFLG_MAX_CANDIDATES; ++i, ++nprinted) {
+                const char *name = cflg_index_spelling(idx, &idx->names[i]);
+                cflg_fprintf(CFLG_STDERR, " '--%.*s'", (int) idx->names[i].len, name);
+            }
+            nfound += hi - lo;
+        }
+        if (nfound > nprinted) {
+            cflg_fprintf(CFLG_STDERR, " and %u more", nfound - nprinted);
         }
 
         break;
     }
-    fprintf(stderr, "\n");
+    cflg_fprintf(CFLG_STDERR, "\n");
 
-    fprintf(stderr, "Try '%s --help' for more information.\n", fs->prog_name);
+    cflg_fprintf(CFLG_STDERR, "Try '%s --help' for more information.\n", fs->prog_name);
+#endif
 }
 
 //
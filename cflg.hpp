@@ -0,0 +1,435 @@
+/*
+ * cflg.hpp - C++17 layer over cflg.h
+ *
+ * Flags are declared once as a constexpr schema over the members of an options struct.
+ * The parser of every flag is picked at compile time from the member's type, and the
+ * lookup index (sorted long names, hash table and short name table) is computed at
+ * compile time as well, so parsing runs the same code as cflg_flgset_parse over a
+ * prebuilt index, with no registration or virtual calls. The library allocates nothing;
+ * only std::vector members allocate, when values are appended to them.
+ *
+ *   ```cpp
+ *     #include "cflg.hpp"
+ *
+ *     struct options {
+ *         bool                       verbose = false;
+ *         int                        count   = 0;
+ *         std::string_view           name;
+ *         std::optional<double>      timeout;
+ *         std::vector<std::uint16_t> ports;
+ *     };
+ *
+ *     constexpr cflg::schema cli{
+ *         cflg::flag('v', "verbose", &options::verbose, "Verbose output"),
+ *         cflg::flag('c', "count", &options::count, "<NUM>", "Stop after <NUM> replies"),
+ *         cflg::flag('n', "name", &options::name, "Name of the service"),
+ *         cflg::flag('W', "timeout", &options::timeout, "<SECS>", "Time to wait for a response"),
+ *         cflg::flag('p', "port", &options::ports, "<PORT>", "Port to listen on, repeatable"),
+ *     };
+ *
+ *     int main(int argc, char *argv[]) {
+ *         options       opts;
+ *         cflg_flgset_t fset = {};
+ *         cflg::parse<cli>(fset, opts, argc, argv);
+ *     }
+ *   ```
+ *
+ * Supported member types:
+ *   - bool: takes no argument, like cflg_flgset_bool.
+ *   - integers of any width and signedness (decimal, 0x hex or 0 octal, range checked).
+ *   - float, double and long double.
+ *   - std::string_view and const char *: point into argv.
+ *   - std::optional<T>: engaged when the flag is given. --no-<name> works for
+ *     std::optional<bool> and std::vector<bool> as for bool, storing false.
+ *   - std::vector<T>: the flag can be repeated, every value is appended.
+ *
+ * A name used by two flags, or a flag without any name, fails to compile. As with
+ * cflg_flgset_parse, '-h' and '--help' give way to flags which use them.
+ *
+ * The implementation is C: compile cflg.h with CFLG_IMPLEMENTATION defined in one C
+ * file and link it. cflg.hpp defines CFLG_NO_SHORT_NAMES, as short names such as OK
+ * would leak into C++ code.
+ */
+
+#ifndef CFLG_HPP_INCLUDE
+#define CFLG_HPP_INCLUDE
+
+#ifndef CFLG_NO_SHORT_NAMES
+#define CFLG_NO_SHORT_NAMES
+#endif
+#include "cflg.h"
+
+#include <array>       // std::array
+#include <cerrno>      // errno
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <cstdlib>     // std::strtoll, std::strtoull, std::strtold
+#include <cstring>     // std::memcpy
+#include <limits>      // std::numeric_limits
+#include <optional>    // std::optional
+#include <string_view> // std::string_view
+#include <tuple>       // std::tuple
+#include <type_traits> // std::is_integral, ...
+#include <utility>     // std::index_sequence
+#include <vector>      // std::vector
+
+namespace cflg {
+
+// a flag bound to the member of type T of the options struct Opts
+template <class Opts, class T> struct flag {
+    using options_type = Opts;
+    using value_type   = T;
+
+    char        name;      // short option, 0 if none
+    const char *name_long; // long option, nullptr if none
+    const char *arg_name;  // argument's name in help, nullptr for the default of T
+    const char *usage;     // usage message
+    T Opts::   *member;    // the bound member
+
+    constexpr flag(char name, const char *name_long, T Opts::*member, const char *usage)
+        : name(name), name_long(name_long), arg_name(nullptr), usage(usage), member(member) {}
+
+    constexpr flag(char name, const char *name_long, T Opts::*member, const char *arg_name, const char *usage)
+        : name(name), name_long(name_long), arg_name(arg_name), usage(usage), member(member) {}
+};
+
+namespace detail {
+
+// --- value parsers ---
+
+template <class T> struct is_optional : std::false_type {};
+template <class T> struct is_optional<std::optional<T>> : std::true_type {};
+
+template <class T> struct is_vector : std::false_type {};
+template <class T, class A> struct is_vector<std::vector<T, A>> : std::true_type {};
+
+// the type of the values a member takes, the element type of optionals and vectors
+template <class T> struct element { using type = T; };
+template <class T> struct element<std::optional<T>> : element<T> {};
+template <class T, class A> struct element<std::vector<T, A>> : element<T> {};
+
+template <class T> int parse_value(cflg_parser_context_t *ctx);
+
+// parses into a temporary and hands it to store if the parser succeeds,
+// used by the containers, so bool elements are set rather than toggled
+template <class T, class Store> int parse_element(cflg_parser_context_t *ctx, Store store) {
+    T                     value{};
+    cflg_parser_context_t inner = *ctx;
+    inner.dest                  = &value;
+    inner.has_been_parsed       = false;
+    int res                     = parse_value<T>(&inner);
+    if (res == CFLG_OK || res == CFLG_OK_NO_ARG) {
+        store(value);
+    }
+    return res;
+}
+
+template <class T> int parse_value(cflg_parser_context_t *ctx) {
+    T &dest = *static_cast<T *>(ctx->dest);
+
+    if constexpr (std::is_same_v<T, bool>) {
+        return cflg_parse_bool(ctx);
+    } else if constexpr (is_optional<T>::value) {
+        return parse_element<typename T::value_type>(ctx, [&](auto &v) { dest = std::move(v); });
+    } else if constexpr (is_vector<T>::value) {
+        return parse_element<typename T::value_type>(ctx, [&](auto &v) { dest.push_back(std::move(v)); });
+    } else {
+        if (ctx->arg == nullptr) {
+            return CFLG_ERR_ARG_NEEDED;
+        }
+        if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, const char *>) {
+            dest = ctx->arg;
+            return CFLG_OK;
+        } else {
+            char *end;
+            errno = 0;
+            if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                long long n = std::strtoll(ctx->arg, &end, 0);
+                if (*end != '\0' || errno == ERANGE || n < std::numeric_limits<T>::min() ||
+                    n > std::numeric_limits<T>::max()) {
+                    return CFLG_ERR_ARG_INVALID;
+                }
+                dest = static_cast<T>(n);
+            } else if constexpr (std::is_integral_v<T>) {
+                unsigned long long n = std::strtoull(ctx->arg, &end, 0);
+                if (*end != '\0' || errno == ERANGE || ctx->arg[0] == '-' || n > std::numeric_limits<T>::max()) {
+                    return CFLG_ERR_ARG_INVALID;
+                }
+                dest = static_cast<T>(n);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                long double n = std::strtold(ctx->arg, &end);
+                if (*end != '\0') {
+                    return CFLG_ERR_ARG_INVALID;
+                }
+                dest = static_cast<T>(n);
+            } else {
+                static_assert(sizeof(T) == 0, "cflg: no parser for the type of this flag");
+            }
+            return CFLG_OK;
+        }
+    }
+}
+
+// the name of the argument in help when the flag doesn't set one, as the C macros do
+template <class T> constexpr const char *default_arg_name() {
+    if constexpr (std::is_same_v<T, bool>) {
+        return nullptr;
+    } else if constexpr (is_optional<T>::value || is_vector<T>::value) {
+        return default_arg_name<typename T::value_type>();
+    } else if constexpr (std::is_integral_v<T>) {
+        return std::is_signed_v<T> ? "int" : "uint";
+    } else if constexpr (std::is_same_v<T, float>) {
+        return "float";
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return "double";
+    } else {
+        return "string";
+    }
+}
+
+// --- compile time index, mirrors cflg_flgset_index ---
+
+// the names of a flag
+struct names {
+    char        name;
+    const char *name_long;
+};
+
+constexpr std::uint32_t length(const char *s) {
+    std::uint32_t n = 0;
+    while (s != nullptr && s[n] != '\0') {
+        ++n;
+    }
+    return n;
+}
+
+constexpr bool equal(const char *a, const char *b) {
+    std::uint32_t n = length(a);
+    if (n == 0 || n != length(b)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// same as cflg_hash
+constexpr std::uint32_t hash(const char *s, std::uint32_t len, std::uint32_t seed) {
+    std::uint32_t h = 2166136261u ^ seed;
+    for (std::uint32_t i = 0; i < len; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// same as cflg_cmp_names, bytes compare as unsigned char like memcmp
+constexpr int compare(const cflg_name_t &a, const cflg_name_t &b) {
+    std::uint32_t n = a.len < b.len ? a.len : b.len;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        int diff = static_cast<unsigned char>(a.name[i]) - static_cast<unsigned char>(b.name[i]);
+        if (diff != 0) {
+            return diff;
+        }
+    }
+    return (a.len > b.len) - (a.len < b.len);
+}
+
+// same as cflg_index_nslots
+constexpr std::uint32_t index_nslots(std::uint32_t nnames) {
+    std::uint32_t n = 2;
+    while (n < 2 * nnames) {
+        n <<= 1;
+    }
+    return n;
+}
+
+template <std::size_t N> constexpr bool defines_short(const std::array<names, N> &flgs, char c) {
+    for (const names &f : flgs) {
+        if (f.name == c) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <std::size_t N> constexpr bool defines_long(const std::array<names, N> &flgs, const char *s) {
+    for (const names &f : flgs) {
+        if (equal(f.name_long, s)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <std::size_t N> constexpr bool has_duplicates(const std::array<names, N> &flgs) {
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = i + 1; j < N; ++j) {
+            if ((flgs[i].name && flgs[i].name == flgs[j].name) || equal(flgs[i].name_long, flgs[j].name_long)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template <std::size_t N> constexpr bool has_unnamed(const std::array<names, N> &flgs) {
+    for (const names &f : flgs) {
+        if (!f.name && length(f.name_long) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// long names of help (id 0) and of the flags (ids 1..N), without the ones help gives way to
+template <std::size_t N> constexpr std::uint32_t count_names(const std::array<names, N> &flgs) {
+    std::uint32_t n = !defines_long(flgs, "help");
+    for (const names &f : flgs) {
+        n += length(f.name_long) != 0;
+    }
+    return n;
+}
+
+// the lookup tables of an index, NNAMES is at least 1 because of help
+template <std::uint32_t NNAMES> struct tables {
+    std::array<cflg_name_t, NNAMES>                 names{};
+    std::array<std::uint32_t, NNAMES>               runs{};
+    std::array<std::uint32_t, index_nslots(NNAMES)> slots{};
+    std::array<std::uint32_t, 256>                  shorts{};
+};
+
+template <std::uint32_t NNAMES, std::size_t N> constexpr tables<NNAMES> build(const std::array<names, N> &flgs) {
+    tables<NNAMES> t{};
+    std::uint32_t  n = 0;
+
+    if (!defines_long(flgs, "help")) {
+        t.names[n++] = cflg_name_t{"help", 4, 0};
+    }
+    if (!defines_short(flgs, 'h')) {
+        t.shorts['h'] = 1;
+    }
+    for (std::uint32_t i = 0; i < N; ++i) {
+        if (flgs[i].name) {
+            t.shorts[static_cast<unsigned char>(flgs[i].name)] = i + 2;
+        }
+        if (length(flgs[i].name_long)) {
+            t.names[n++] = cflg_name_t{flgs[i].name_long, length(flgs[i].name_long), i + 1};
+        }
+    }
+
+    // insertion sort, std::sort isn't constexpr before C++20
+    for (std::uint32_t i = 1; i < NNAMES; ++i) {
+        cflg_name_t   name = t.names[i];
+        std::uint32_t j    = i;
+        for (; j > 0 && compare(t.names[j - 1], name) > 0; --j) {
+            t.names[j] = t.names[j - 1];
+        }
+        t.names[j] = name;
+    }
+
+    std::uint32_t mask = index_nslots(NNAMES) - 1;
+    for (std::uint32_t i = 0; i < NNAMES; ++i) {
+        t.runs[i]          = i == 0 ? 0 : t.runs[i - 1] + (t.names[i].id != t.names[i - 1].id);
+        std::uint32_t slot = hash(t.names[i].name, t.names[i].len, 0) & mask;
+        while (t.slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        t.slots[slot] = i + 1;
+    }
+    return t;
+}
+
+} // namespace detail
+
+// a constexpr list of flags over the members of Opts
+template <class Opts, class... Ts> struct schema {
+    using options_type = Opts;
+
+    static constexpr std::size_t size = sizeof...(Ts);
+
+    std::tuple<flag<Opts, Ts>...>   flags;
+    std::array<detail::names, size> names;
+
+    constexpr schema(flag<Opts, Ts>... flgs) : flags(flgs...), names{{detail::names{flgs.name, flgs.name_long}...}} {}
+};
+
+namespace detail {
+
+// the index of a schema, computed once per schema at compile time
+template <const auto &S> struct compiled {
+    static constexpr std::uint32_t nflgs  = static_cast<std::uint32_t>(std::decay_t<decltype(S)>::size) + 1;
+    static constexpr std::uint32_t nnames = count_names(S.names);
+    static constexpr auto          tables = build<nnames>(S.names);
+};
+
+template <class Opts, class T> void bind(cflg_flg_t &f, const flag<Opts, T> &def, Opts &opts) {
+    f           = cflg_flg_t{};
+    f.parser    = &parse_value<T>;
+    f.dest      = &(opts.*def.member);
+    f.usage     = def.usage;
+    f.arg_name  = def.arg_name ? def.arg_name : default_arg_name<T>();
+    f.name_long = def.name_long;
+    f.name      = def.name;
+    f.negatable = std::is_same_v<typename element<T>::type, bool>;
+}
+
+template <class Schema, std::size_t... I>
+void bind_all(cflg_flg_t *flgs, const Schema &s, typename Schema::options_type &opts, std::index_sequence<I...>) {
+    (bind(flgs[I], std::get<I>(s.flags), opts), ...);
+}
+
+} // namespace detail
+
+// parses argv into opts according to the schema S, a constexpr variable with static storage.
+// behaves as cflg_flgset_parse, which it calls over flags and an index living in static
+// storage, so fset stays valid after returning; a schema can be parsed once per program.
+template <const auto &S>
+int parse(cflg_flgset_t &fset, typename std::decay_t<decltype(S)>::options_type &opts, int argc, char *argv[]) {
+    using C = detail::compiled<S>;
+    static_assert(std::decay_t<decltype(S)>::size > 0, "cflg: a schema needs at least one flag");
+    static_assert(!detail::has_unnamed(S.names), "cflg: every flag needs a short or a long name");
+    static_assert(!detail::has_duplicates(S.names), "cflg: a flag name is defined more than once");
+
+    // constant initialized copies, the library takes non-const pointers
+    static auto          names = C::tables.names;
+    static auto          runs  = C::tables.runs;
+    static auto          slots = C::tables.slots;
+    static cflg_flg_t    flgs[C::nflgs - 1];
+    static cflg_flg_t   *by_id[C::nflgs];
+    static std::uint64_t seen[(C::nflgs + 63) / 64];
+    static cflg_index_t  index;
+
+    detail::bind_all(flgs, S, opts, std::make_index_sequence<C::nflgs - 1>{});
+    for (std::uint32_t id = 1; id < C::nflgs; ++id) {
+        flgs[id - 1].id   = id;
+        flgs[id - 1].next = id + 1 < C::nflgs ? &flgs[id] : nullptr;
+        by_id[id]         = &flgs[id - 1];
+    }
+
+    index            = cflg_index_t{};
+    index.flgs       = by_id;
+    index.nflgs      = C::nflgs;
+    index.names      = names.data();
+    index.runs       = runs.data();
+    index.nnames     = C::nnames;
+    index.slots      = slots.data();
+    index.slots_mask = static_cast<std::uint32_t>(slots.size() - 1);
+    index.seen       = seen;
+    std::memcpy(index.shorts, C::tables.shorts.data(), sizeof(index.shorts));
+
+    fset.flgs  = flgs;
+    fset.index = &index;
+    return cflg_flgset_parse(&fset, argc, argv);
+}
+
+} // namespace cflg
+
+#endif // CFLG_HPP_INCLUDE
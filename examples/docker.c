@@ -19,6 +19,11 @@ typedef struct {
   size_t capacity;
 } string_list_t;
 
+// Valid values of --restart and --network
+const char *const restart_policies[] = {"no", "on-failure", "always",
+                                        "unless-stopped", NULL};
+const char *const networks[] = {"bridge", "host", "none", NULL};
+
 // Structure for user (UID:GID)
 typedef struct {
   uint16_t uid;
@@ -29,7 +34,7 @@ typedef struct {
 
 /**
  * @brief Generic parser to add an argument to a dynamic list of strings.
- * Used for --env, --volume, --cap-add, --cap-drop, and --publish.
+ * Used for --volume, --cap-add, --cap-drop, and --publish.
  */
 int list_parser(parser_context_t *ctx) {
 
@@ -169,17 +174,20 @@ int main(int argc, char *argv[]) {
   bool read_only = false;
   bool remove_on_exit = false;
   char *container_name = NULL;
-  char *restart_policy = "no";
-  char *network = "bridge";
+  int restart_policy = 0;
+  int network = 0;
   char *host_name = NULL;
   char *work_dir = NULL;
   double ncpus = 0.0;
+  int cpuset_ids[64];
+  cflg_array_t cpuset = {.items = cpuset_ids, .cap = 64};
   long long memory = 0;
   long long mem_swap = 0;
   user_t user = {0};
   string_list_t published_ports = {0};
   string_list_t volumes = {0};
-  string_list_t env_vars = {0};
+  cflg_map_entry_t env_slots[64] = {0};
+  cflg_map_t env_vars = {.slots = env_slots, .mask = 63};
   string_list_t caps_to_add = {0};
   string_list_t caps_to_drop = {0};
 
@@ -196,15 +204,18 @@ int main(int argc, char *argv[]) {
               "Automatically remove the container when it exits");
   flgset_string(&fset, &container_name, 0, "name", "<NAME>",
                 "Assign a name to the container");
-  flgset_string(&fset, &restart_policy, 0, "restart", "<POLICY>",
-                "Restart policy to apply when a container exits");
-  flgset_string(&fset, &network, 0, "network", "<NET>",
-                "Connect a container to a network");
+  flgset_enum_list(&fset, &restart_policy, 0, "restart", "<POLICY>",
+                   "Restart policy to apply when a container exits",
+                   restart_policies);
+  flgset_enum_list(&fset, &network, 0, "network", "<NET>",
+                   "Connect a container to a network", networks);
   flgset_string(&fset, &host_name, 0, "hostname", "<NAME>",
                 "Container host name");
   flgset_string(&fset, &work_dir, 'w', "workdir", "<PATH>",
                 "Working directory inside the container");
   flgset_double(&fset, &ncpus, 0, "cpus", "<NUM>", "Number of CPUs");
+  flgset_int_array(&fset, &cpuset, 0, "cpuset-cpus", "<LIST>",
+                   "CPUs in which to allow execution (e.g., 0-3,8)");
   flgset_bool(&fset, &read_only, 0, "read-only",
               "Mount the container's root filesystem as read-only");
 
@@ -213,15 +224,18 @@ int main(int argc, char *argv[]) {
               "Publish a container's port(s) to the host", list_parser);
   flgset_func(&fset, &volumes, 'v', "volume", "<HOST:CONT>",
               "Bind mount a volume", list_parser);
-  flgset_func(&fset, &env_vars, 'e', "env", "<KEY=VAL>",
-              "Set environment variables", list_parser);
+  flgset_map(&fset, &env_vars, 'e', "env", "<KEY=VAL>",
+             "Set environment variables");
   flgset_func(&fset, &memory, 0, "memory", "<SIZE>",
               "Memory limit (e.g., 512m, 1g)", mem_parser);
   flgset_func(&fset, &mem_swap, 0, "memory-swap", "<SIZE>",
               "Swap limit equal to memory plus swap", mem_parser);
-  flgset_func(&fset, &user, 0, "user", "<UID:GID>",
-              "Username or UID (format: <name|uid>[:<group|gid>])",
-              user_parser);
+  // resolving user names can be slow, so the parser only runs once the value
+  // is asked for with cflg_lazy_get
+  flg_t *user_flg =
+      flgset_lazy(&fset, &user, 0, "user", "<UID:GID>",
+                  "Username or UID (format: <name|uid>[:<group|gid>])",
+                  user_parser);
   flgset_func(&fset, &caps_to_add, 0, "cap-add", "<CAP>",
               "Add Linux capabilities", list_parser);
   flgset_func(&fset, &caps_to_drop, 0, "cap-drop", "<CAP>",
@@ -245,20 +259,34 @@ int main(int argc, char *argv[]) {
   printf("  %-*s %s\n", label_width, "Pseudo-TTY (-t):", btoa(allocate_ptty));
   printf("  %-*s %s\n", label_width,
          "Remove on Exit (--rm):", btoa(remove_on_exit));
-  printf("  %-*s %s\n", label_width, "Restart Policy:", restart_policy);
+  printf("  %-*s %s\n", label_width, "Restart Policy:",
+         restart_policies[restart_policy]);
   printf("  %-*s %s\n", label_width,
          "Working Directory:", work_dir ? work_dir : "(default: /)");
-  print_and_free_list("Environment Vars (-e):", &env_vars, label_width);
+  printf("  %-*s ", label_width, "Environment Vars (-e):");
+  printf("%s", env_vars.count == 0 ? "(none)\n" : "\n");
+  for (uint32_t i = 0; i <= env_vars.mask; ++i) {
+    cflg_map_entry_t *e = &env_vars.slots[i];
+    if (e->key != NULL) {
+      printf("%*s- %.*s=%s\n", label_width + 4, "", (int)e->key_len, e->key,
+             e->value ? e->value : "(from host)");
+    }
+  }
   printf("\n");
 
   printf("Resources:\n");
   printf("  %-*s %.2f\n", label_width, "CPU Limit:", ncpus);
+  printf("  %-*s", label_width, "CPU Set:");
+  for (uint32_t i = 0; i < cpuset.count; ++i) {
+    printf(" %d", cpuset_ids[i]);
+  }
+  printf("%s\n", cpuset.count == 0 ? " (all)" : cpuset.overflow ? " ..." : "");
   printf("  %-*s %lld bytes\n", label_width, "Memory Limit:", memory);
   printf("  %-*s %lld bytes\n", label_width, "Memory+Swap Limit:", mem_swap);
   printf("\n");
 
   printf("Network & Storage:\n");
-  printf("  %-*s %s\n", label_width, "Network:", network);
+  printf("  %-*s %s\n", label_width, "Network:", networks[network]);
   printf("  %-*s %s\n", label_width,
          "Hostname:", host_name ? host_name : "(generated)");
   print_and_free_list("Published Ports (-p):", &published_ports, label_width);
@@ -266,7 +294,8 @@ int main(int argc, char *argv[]) {
   printf("\n");
 
   printf("Security & Permissions:\n");
-  printf("  %-*s %d:%d\n", label_width, "User (UID:GID):", user.uid, user.gid);
+  user_t *u = cflg_lazy_get(&fset, user_flg);
+  printf("  %-*s %d:%d\n", label_width, "User (UID:GID):", u->uid, u->gid);
   printf("  %-*s %s\n", label_width, "Read-Only Root FS:", btoa(read_only));
   print_and_free_list("Capabilities to Add:", &caps_to_add, label_width);
   print_and_free_list("Capabilities to Drop:", &caps_to_drop, label_width);
@@ -0,0 +1,128 @@
+// Measures how parsing a huge argv scales with the number of threads looking up
+// long options. Build with:
+//
+//   cc -O2 -DCFLG_THREADS -pthread -o parallel examples/parallel.c
+//   ./parallel [NARGS] [MAX_THREADS]
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+// Number of generated flags, override with -DNFLAGS=...
+#ifndef NFLAGS
+#define NFLAGS 1000
+#endif
+
+// --- Arena ---
+
+// Grows the flag set's arena with blocks from malloc, see plugins.c.
+bool arena_grow(cflg_arena_t *arena, size_t size) {
+  size_t cap = size > 1024 * 1024 ? size : 1024 * 1024;
+  unsigned char *block = malloc(cap);
+  if (block == NULL) {
+    return false;
+  }
+  arena->base = block;
+  arena->cap = cap;
+  return true;
+}
+
+// --- Workload ---
+
+static char names[NFLAGS][32];
+static int values[NFLAGS];
+
+// Every fourth argument is a flag, with its value in the next argument every
+// other time; the rest are paths.
+char **make_argv(int nargs) {
+  char **argv = malloc((nargs + 1) * sizeof(char *));
+  argv[0] = "parallel";
+  for (int i = 1; i < nargs; ++i) {
+    char buf[64];
+    int f = (int)((uint32_t)i * 2654435761u % NFLAGS);
+    if (i % 4 == 1 && i + 1 < nargs) {
+      snprintf(buf, sizeof(buf), "--%s", names[f]);
+      argv[i] = strdup(buf);
+      argv[++i] = strdup("42");
+    } else if (i % 4 == 3) {
+      snprintf(buf, sizeof(buf), "--%s=%d", names[f], i % 1000);
+      argv[i] = strdup(buf);
+    } else {
+      snprintf(buf, sizeof(buf), "/data/shard-%d/part-%08d", i % 64, i);
+      argv[i] = strdup(buf);
+    }
+  }
+  argv[nargs] = NULL;
+  return argv;
+}
+
+double elapsed(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Parses a copy of argv with the given number of threads, returns the seconds
+// spent in cflg_flgset_parse and a checksum of the results.
+double run(char **argv, int nargs, int threads, uint64_t *sum) {
+  char **args = malloc((nargs + 1) * sizeof(char *));
+  memcpy(args, argv, (nargs + 1) * sizeof(char *));
+  memset(values, 0, sizeof(values));
+
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  fset.threads = threads;
+  for (int i = 0; i < NFLAGS; ++i) {
+    cflg_flgset_add(&fset, cflg_parse_int, &values[i], 0, names[i], "<NUM>",
+                    "Generated flag");
+  }
+
+  struct timespec start, end;
+  timespec_get(&start, TIME_UTC);
+  flgset_parse(&fset, nargs, args);
+  timespec_get(&end, TIME_UTC);
+
+  *sum = fset.narg;
+  for (int i = 0; i < NFLAGS; ++i) {
+    *sum = *sum * 31 + values[i];
+  }
+  for (int i = 0; i < fset.narg; ++i) {
+    *sum = *sum * 31 + (uintptr_t)fset.args[i];
+  }
+  free(args);
+  return elapsed(&start, &end);
+}
+
+int main(int argc, char *argv[]) {
+  int nargs = argc > 1 ? atoi(argv[1]) : 2000000;
+  int max_threads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (nargs < 2 || max_threads < 1) {
+    fprintf(stderr, "usage: %s [NARGS] [MAX_THREADS]\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = 0; i < NFLAGS; ++i) {
+    snprintf(names[i], sizeof(names[i]), "shard-option-%d", i);
+  }
+  char **args = make_argv(nargs);
+
+  printf("--- Parallel Parsing Benchmark ---\n\n");
+  printf("  %-24s %d\n", "Arguments:", nargs);
+  printf("  %-24s %d\n\n", "Flags:", NFLAGS);
+  printf("  %8s %12s %9s\n", "Threads", "Seconds", "Speedup");
+
+  uint64_t serial_sum;
+  double serial = run(args, nargs, 1, &serial_sum);
+  printf("  %8d %12.6f %8.2fx\n", 1, serial, 1.0);
+  for (int threads = 2; threads <= max_threads; threads *= 2) {
+    uint64_t sum;
+    double secs = run(args, nargs, threads, &sum);
+    printf("  %8d %12.6f %8.2fx%s\n", threads, secs, serial / secs,
+           sum == serial_sum ? "" : "  (results differ!)");
+  }
+  return 0;
+}
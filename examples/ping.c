@@ -57,8 +57,9 @@ int main(int argc, char *argv[]) {
               "Print timestamp before each line.");
   flgset_bool(&fset, &precision, '3', NULL,
               "RTT precision, do not round (legacy).");
-  flgset_bool(&fset, &ipv4_only, '4', NULL, "Use IPv4 only.");
-  flgset_bool(&fset, &ipv6_only, '6', NULL, "Use IPv6 only.");
+  flg_t *ipv4 = flgset_bool(&fset, &ipv4_only, '4', NULL, "Use IPv4 only.");
+  flg_t *ipv6 = flgset_bool(&fset, &ipv6_only, '6', NULL, "Use IPv6 only.");
+  flgset_constrain(&fset, CFLG_AT_MOST_ONE, ipv4, ipv6);
 
   // Integer Flags
   flgset_int64(&fset, &count, 'c', "", "<NUM>",
@@ -0,0 +1,174 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+// Number of generated flags, override with -DNFLAGS=...
+#ifndef NFLAGS
+#define NFLAGS 10000
+#endif
+
+// --- Arena ---
+
+// Grows the flag set's arena with blocks from malloc.
+// Old blocks are never freed, flags and names allocated from them stay valid.
+bool arena_grow(cflg_arena_t *arena, size_t size) {
+  size_t cap = size > 64 * 1024 ? size : 64 * 1024;
+  unsigned char *block = malloc(cap);
+  if (block == NULL) {
+    return false;
+  }
+  arena->base = block;
+  arena->cap = cap;
+  return true;
+}
+
+// --- Schema ---
+
+// A plugin option, as it would be read from a schema file.
+typedef struct {
+  char name[64];
+  char usage[96];
+  int kind; // 0: bool, 1: int, 2: string
+} option_t;
+
+// Stands in for reading schema files from disk.
+void load_schema(option_t *opts, int n) {
+  for (int i = 0; i < n; ++i) {
+    opts[i].kind = i % 3;
+    snprintf(opts[i].name, sizeof(opts[i].name), "plugin%d-option%d", i / 16,
+             i % 16);
+    snprintf(opts[i].usage, sizeof(opts[i].usage),
+             "Option %d of plugin %d", i % 16, i / 16);
+  }
+}
+
+static const cflg_parser_t parsers[] = {cflg_parse_bool, cflg_parse_int,
+                                        cflg_parse_string};
+static const char *arg_names[] = {NULL, "<NUM>", "<STR>"};
+
+#ifdef COMPACT
+// Build with -DCOMPACT to keep the definitions as 16 byte records over one
+// string pool, which is all that has to stay around between parses.
+static cflg_compact_flg_t records[NFLAGS];
+static char pool[NFLAGS * 48];
+static uint32_t pool_slots[1 << 15];
+static cflg_compact_t compact = {.flgs = records,
+                                 .cap = NFLAGS,
+                                 .parsers = parsers,
+                                 .nparsers = 3,
+                                 .pool = pool,
+                                 .pool_cap = sizeof(pool),
+                                 .slots = pool_slots,
+                                 .slots_mask = (1 << 15) - 1};
+
+bool register_options(flgset_t *fset, option_t *opts, int n, void **values) {
+  compact.dests = values;
+  for (int i = 0; i < n; ++i) {
+    if (!cflg_compact_add(&compact, opts[i].kind, values[i], 0, opts[i].name,
+                          arg_names[opts[i].kind], opts[i].usage)) {
+      return false;
+    }
+  }
+  return cflg_flgset_add_compact(fset, &compact);
+}
+#else
+// Registers one flag per option; runs in a helper function, so compound
+// literals can't be used here.
+bool register_options(flgset_t *fset, option_t *opts, int n, void **values) {
+  for (int i = 0; i < n; ++i) {
+    // the schema buffer is temporary, copy the strings into the arena
+    const char *name = cflg_arena_strdup(&fset->arena, opts[i].name);
+    const char *usage = cflg_arena_strdup(&fset->arena, opts[i].usage);
+    if (name == NULL || usage == NULL ||
+        cflg_flgset_add(fset, parsers[opts[i].kind], values[i], 0, name,
+                        arg_names[opts[i].kind], usage) == NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+#endif
+
+double elapsed(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+  // --- Variable Definitions ---
+  static option_t opts[NFLAGS];
+  static union {
+    bool b;
+    int i;
+    char *s;
+  } values[NFLAGS];
+  static void *dests[NFLAGS];
+  bool verbose = false;
+
+  for (int i = 0; i < NFLAGS; ++i) {
+    dests[i] = &values[i];
+  }
+  load_schema(opts, NFLAGS);
+
+  // --- Flag Set Initialization ---
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+
+  flgset_bool(&fset, &verbose, 'v', "verbose", "Verbose output");
+
+  // --- Registration ---
+  struct timespec start, registered, end;
+  timespec_get(&start, TIME_UTC);
+  if (!register_options(&fset, opts, NFLAGS, dests)) {
+    fprintf(stderr, "%s: out of memory\n", argv[0]);
+    return 1;
+  }
+  timespec_get(&registered, TIME_UTC);
+
+  // --- Parsing ---
+  flgset_parse(&fset, argc, argv);
+  timespec_get(&end, TIME_UTC);
+
+  // --- Print Results ---
+  printf("--- Plugin Host Results ---\n\n");
+  printf("  %-24s %d\n", "Generated Flags:", NFLAGS);
+  printf("  %-24s %s\n", "Verbose:", verbose ? "true" : "false");
+#ifdef COMPACT
+  printf("  %-24s %zu + %u pool bytes\n", "Compact Definitions:",
+         compact.nflgs * sizeof(cflg_compact_flg_t), compact.pool_len);
+  printf("  %-24s %zu arena bytes\n", "Expanded for Parsing:",
+         compact.nflgs * sizeof(cflg_flg_t));
+#endif
+  for (int i = 0; i < NFLAGS; ++i) {
+    if (values[i].i == 0) {
+      continue;
+    }
+    switch (opts[i].kind) {
+    case 0:
+      printf("  --%-22s true\n", opts[i].name);
+      break;
+    case 1:
+      printf("  --%-22s %d\n", opts[i].name, values[i].i);
+      break;
+    case 2:
+      printf("  --%-22s %s\n", opts[i].name, values[i].s);
+      break;
+    }
+  }
+
+  printf("\nNon Flags:\n");
+  for (int i = 0; i < fset.narg; ++i) {
+    printf("  %s\n", fset.args[i]);
+  }
+
+  printf("\n----------------------------------\n");
+  printf("Flags registered in %.9f seconds\n", elapsed(&start, &registered));
+  printf("Flags parsed in %.9f seconds\n", elapsed(&registered, &end));
+
+  return 0;
+}
@@ -0,0 +1,46 @@
+// A ping front end whose flags are compiled ahead of time by tools/cflg_gen.c,
+// parsing starts without registering, indexing or sorting any flag.
+//
+// Build:
+//   cc -o cflg_gen tools/cflg_gen.c
+//   ./cflg_gen -p ping -o examples/precompiled_flags.h examples/precompiled.flags
+//   cc -o precompiled examples/precompiled.c
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+#include "precompiled_flags.h"
+
+static const char *pmtudisc_hints[] = {"do", "want", "dont", "probe"};
+
+int main(int argc, char *argv[]) {
+  // --- Parsing ---
+  flgset_parse(&ping_flgset, argc, argv);
+
+  // --- Print Results ---
+  printf("--- Ping Command Results ---\n\n");
+  printf("  %-24s %s\n", "Verbose:", ping.verbose ? "true" : "false");
+  printf("  %-24s %s\n", "Quiet:", ping.quiet ? "true" : "false");
+  printf("  %-24s %s\n", "IPv4 Only:", ping.flag_4 ? "true" : "false");
+  printf("  %-24s %s\n", "IPv6 Only:", ping.flag_6 ? "true" : "false");
+  printf("  %-24s %lld\n", "Count:", (long long)ping.count);
+  printf("  %-24s %d\n", "Deadline:", ping.deadline);
+  printf("  %-24s %d\n", "TTL:", ping.ttl);
+  printf("  %-24s %u\n", "Packet Size:", ping.size);
+  printf("  %-24s %.3f\n", "Interval:", ping.interval);
+  printf("  %-24s %.3f\n", "Timeout:", ping.timeout);
+  printf("  %-24s %s\n", "Interface:",
+         ping.interface ? ping.interface : "(not set)");
+  printf("  %-24s %s\n", "PMTU Discovery:", pmtudisc_hints[ping.pmtudisc]);
+
+  printf("\nNon Flags:\n");
+  for (int i = 0; i < ping_flgset.narg; ++i) {
+    printf("  %s\n", ping_flgset.args[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,114 @@
+// A worker whose settings follow edits of a config file while it runs. One thread
+// watches the file, the main thread keeps reading the values. Build with:
+//
+//   cc -O2 -DCFLG_WATCH -pthread -o reload examples/reload.c
+//   ./reload [--config=reload.conf] [--workers=N]
+//
+// and edit reload.conf from another terminal, e.g. 'rate = 250' or 'mode = drain'.
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+static const char *default_config = "# reloaded whenever it's saved\n"
+                                    "rate = 100\n"
+                                    "ratio = 0.5\n"
+                                    "mode = normal\n"
+                                    "banner = hello\n";
+
+static const char *modes[] = {"normal", "drain", "pause", NULL};
+
+static cflg_watch_t watch;
+static volatile bool running = true;
+
+void *watch_thread(void *arg) {
+  (void)arg;
+  while (running) {
+    int changed = cflg_watch_poll(&watch, 200);
+    if (changed > 0) {
+      printf("reloaded, %d value(s) changed\n", changed);
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  // --- Variable Definitions ---
+  int rate = 0;
+  double ratio = 0;
+  int mode = 0;
+  char *banner = "";
+  int workers = 1;
+  int seconds = 30;
+  char *config = "reload.conf";
+  bool help = false;
+
+  // --- Flag Set Initialization ---
+  static uint64_t mem[2048];
+  flgset_t fset = {0};
+  fset.arena = (cflg_arena_t){.base = (unsigned char *)mem, .cap = sizeof(mem)};
+
+  flgset_int(&fset, &rate, 'r', "rate", "<NUM>", "Requests per second");
+  flgset_double(&fset, &ratio, 0, "ratio", "<VAL>", "Share of sampled requests");
+  flgset_enum_list(&fset, &mode, 'm', "mode", "<MODE>", "normal, drain or pause",
+                   modes);
+  flgset_string(&fset, &banner, 'b', "banner", "<STR>", "Greeting to print");
+  flgset_int(&fset, &workers, 'w', "workers", "<NUM>",
+             "Number of workers (command line only)");
+  flgset_int(&fset, &seconds, 's', "seconds", "<NUM>", "How long to run");
+  flgset_string(&fset, &config, 'c', "config", "<FILE>", "Config file to watch");
+  flgset_bool(&fset, &help, 'h', "help", "Print help");
+
+  // --- Parsing ---
+  flgset_parse(&fset, argc, argv);
+  if (help) {
+    printf("Usage: %s [OPTIONS]\n\nOptions:\n", fset.prog_name);
+    cflg_print_flags(fset.flgs);
+    return 0;
+  }
+
+  // create a config to start with
+  if (access(config, F_OK) != 0) {
+    FILE *f = fopen(config, "w");
+    if (f == NULL) {
+      perror(config);
+      return 1;
+    }
+    fputs(default_config, f);
+    fclose(f);
+  }
+
+  // --- Watching ---
+  static char buf[2 * 16384];
+  if (!cflg_watch_open(&watch, &fset, config, buf, sizeof(buf))) {
+    return 1;
+  }
+  pthread_t thread;
+  pthread_create(&thread, NULL, watch_thread, NULL);
+
+  // --- Print Results ---
+  printf("--- Reload Results (%d worker(s), watching %s) ---\n\n", workers,
+         config);
+  for (int i = 0; i < seconds; ++i) {
+    int r, m;
+    double s;
+    char *b;
+    cflg_watch_read(&watch, &rate, &r, sizeof(r));
+    cflg_watch_read(&watch, &ratio, &s, sizeof(s));
+    cflg_watch_read(&watch, &mode, &m, sizeof(m));
+    cflg_watch_read(&watch, &banner, &b, sizeof(b));
+    printf("  rate=%-6d ratio=%-6.3f mode=%-7s banner=%s\n", r, s, modes[m], b);
+    sleep(1);
+  }
+
+  running = false;
+  pthread_join(thread, NULL);
+  cflg_watch_close(&watch);
+  return 0;
+}
@@ -0,0 +1,69 @@
+// A service front end using the C++ layer, flags are declared as a constexpr
+// schema and parsed into a plain options struct.
+//
+// Build (the library itself is compiled as C):
+//   cc -c -x c -DCFLG_IMPLEMENTATION -o cflg.o cflg.h
+//   c++ -std=c++17 -o service examples/service.cpp cflg.o
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "../cflg.hpp"
+
+struct options {
+  bool verbose = false;
+  int workers = 4;
+  std::string_view name = "service";
+  std::optional<double> timeout;
+  std::vector<std::uint16_t> ports;
+  std::uint64_t max_body = 1 << 20;
+};
+
+constexpr cflg::schema cli{
+    cflg::flag('v', "verbose", &options::verbose, "Verbose output."),
+    cflg::flag('w', "workers", &options::workers, "<NUM>",
+               "Number of worker threads."),
+    cflg::flag('n', "name", &options::name, "<NAME>",
+               "Name reported in logs."),
+    cflg::flag('t', "timeout", &options::timeout, "<SECS>",
+               "Close idle connections after <SECS> seconds."),
+    cflg::flag('p', "port", &options::ports, "<PORT>",
+               "Listen on <PORT>, can be repeated."),
+    cflg::flag(0, "max-body", &options::max_body, "<BYTES>",
+               "Largest accepted request body."),
+};
+
+int main(int argc, char *argv[]) {
+  // --- Parsing ---
+  options opts;
+  cflg_flgset_t fset = {};
+  cflg::parse<cli>(fset, opts, argc, argv);
+
+  // --- Print Results ---
+  std::printf("--- Service Results ---\n\n");
+  std::printf("  %-24s %s\n", "Verbose:", opts.verbose ? "true" : "false");
+  std::printf("  %-24s %d\n", "Workers:", opts.workers);
+  std::printf("  %-24s %.*s\n", "Name:", static_cast<int>(opts.name.size()),
+              opts.name.data());
+  if (opts.timeout) {
+    std::printf("  %-24s %.3f\n", "Timeout:", *opts.timeout);
+  } else {
+    std::printf("  %-24s %s\n", "Timeout:", "(not set)");
+  }
+  std::printf("  %-24s", "Ports:");
+  for (std::uint16_t port : opts.ports) {
+    std::printf(" %u", port);
+  }
+  std::printf("\n  %-24s %llu\n", "Max Body:",
+              static_cast<unsigned long long>(opts.max_body));
+
+  std::printf("\nNon Flags:\n");
+  for (int i = 0; i < fset.narg; ++i) {
+    std::printf("  %s\n", fset.args[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,311 @@
+// complexity - checks that parsing adversarial argv scales as documented under
+// "Complexity" in cflg.h.
+//
+// Every case is timed at a size N and at 2N, keeping the fastest of a few runs,
+// and the ratio of the two times must stay under a bound: about 2 for linear
+// work, where a quadratic path would give 4. Cases which must not depend on
+// the number of flags at all are checked against a tighter bound.
+//
+//   - a 1 MB short option cluster (-vvvv...)
+//   - thousands of ambiguous '--a' prefixes against thousands of flags named a*
+//   - 10k+ flags defined in reverse order, sorted for --help
+//   - huge runs of positional arguments
+//   - thousands of occurrences of an arena-backed array flag
+//   - thousands of huge ranges (--xs=0-4000000000) given to an array without cap
+//
+// Build and run (exits with 1 if a bound is exceeded):
+//
+//   cc -O2 -o complexity tests/complexity.c && ./complexity
+
+#define _POSIX_C_SOURCE 200809L // clock_gettime, strdup
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+// runs of each size, the fastest one counts
+#define RUNS 5
+
+// time(2N) / time(N) for linear work, and for work which must not grow with the
+// number of flags
+#define LINEAR_BOUND 3.0
+#define FLAT_BOUND 1.6
+
+// --- Helpers ---
+
+double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Grows an arena with blocks from malloc, see examples/plugins.c.
+bool arena_grow(cflg_arena_t *arena, size_t size) {
+  size_t cap = size > 1024 * 1024 ? size : 1024 * 1024;
+  unsigned char *block = malloc(cap);
+  if (block == NULL) {
+    return false;
+  }
+  arena->base = block;
+  arena->cap = cap;
+  return true;
+}
+
+// names of generated flags, kept for the whole run
+char *flag_name(const char *prefix, int i) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%s%d", prefix, i);
+  return strdup(buf);
+}
+
+typedef double (*case_fn)(int n);
+
+// fastest of RUNS runs of fn(n)
+double best(case_fn fn, int n) {
+  double t = fn(n);
+  for (int i = 1; i < RUNS; ++i) {
+    double u = fn(n);
+    t = u < t ? u : t;
+  }
+  return t;
+}
+
+static int failures = 0;
+
+void check(const char *name, case_fn fn, int n, double bound) {
+  double t1 = best(fn, n), t2 = best(fn, 2 * n);
+  double ratio = t2 / (t1 > 1e-9 ? t1 : 1e-9);
+  bool ok = ratio < bound;
+  failures += !ok;
+  printf("  %-28s N=%-8d %9.6fs  2N %9.6fs  ratio %5.2f < %.1f  %s\n", name, n,
+         t1, t2, ratio, bound, ok ? "ok" : "FAIL");
+}
+
+// --- Cases ---
+
+// one argument of n grouped short options
+double short_cluster(int n) {
+  char *cluster = malloc(n + 2);
+  cluster[0] = '-';
+  memset(cluster + 1, 'v', n);
+  cluster[n + 1] = '\0';
+  char *argv[] = {"complexity", cluster, NULL};
+
+  bool verbose = false;
+  flgset_t fset = {0};
+  flgset_bool(&fset, &verbose, 'v', "verbose", "Verbose");
+
+  double start = now();
+  flgset_parse(&fset, 2, argv);
+  double t = now() - start;
+  free(cluster);
+  return t;
+}
+
+// 20000 ambiguous '--a' against n flags named a<i>, read with cflg_next (which
+// doesn't exit) and reported like cflg_flgset_parse would, to /dev/null
+static char **a_names;
+
+double ambiguous_prefixes(int n) {
+  enum { NARGS = 20000 };
+  static char *argv[NARGS + 1];
+  argv[0] = "complexity";
+  for (int i = 1; i < NARGS; ++i) {
+    argv[i] = "--a";
+  }
+
+  static int values[1 << 16];
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  for (int i = 0; i < n; ++i) {
+    cflg_flgset_add(&fset, cflg_parse_int, &values[i], 0, a_names[i], "<NUM>",
+                    "Generated");
+  }
+
+  // building the index is O(n log n), only reading the arguments is timed
+  cflg_iter_t it;
+  cflg_event_t ev;
+  cflg_iter_init(&it, &fset, NARGS, argv);
+  double start = now();
+  int nerrors = 0;
+  while (cflg_next(&it, &ev)) {
+    if (ev.kind == CFLG_EVENT_ERROR) {
+      cflg_iter_print_err(&it, &ev);
+      nerrors++;
+    }
+  }
+  double t = now() - start;
+  if (nerrors != NARGS - 1) {
+    printf("  ambiguous prefixes: %d errors instead of %d\n", nerrors,
+           NARGS - 1);
+    failures++;
+  }
+  return t;
+}
+
+// the same 20000 prefixes against a fixed set, to check the cost per argument
+double ambiguous_args(int n) {
+  static char *argv[1 << 18];
+  argv[0] = "complexity";
+  for (int i = 1; i < n; ++i) {
+    argv[i] = "--a";
+  }
+
+  static int values[2000];
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  for (int i = 0; i < 2000; ++i) {
+    cflg_flgset_add(&fset, cflg_parse_int, &values[i], 0, a_names[i], "<NUM>",
+                    "Generated");
+  }
+
+  cflg_iter_t it;
+  cflg_event_t ev;
+  cflg_iter_init(&it, &fset, n, argv);
+  double start = now();
+  while (cflg_next(&it, &ev)) {
+    if (ev.kind == CFLG_EVENT_ERROR) {
+      cflg_iter_print_err(&it, &ev);
+    }
+  }
+  return now() - start;
+}
+
+// n flags defined with descending names, sorted as --help does
+static char **f_names;
+
+double reverse_sort(int n) {
+  static bool values[1 << 17];
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  for (int i = n - 1; i >= 0; --i) {
+    cflg_flgset_add(&fset, cflg_parse_bool, &values[i], 0, f_names[i], NULL,
+                    "Generated");
+  }
+
+  double start = now();
+  cflg_sort_flags(&fset.flgs);
+  double t = now() - start;
+
+  int i = 0;
+  for (cflg_flg_t *f = fset.flgs; f != NULL && f->next != NULL; f = f->next) {
+    if (strcmp(f->name_long, f->next->name_long) > 0 && i++ == 0) {
+      printf("  reverse sort: '%s' before '%s'\n", f->name_long,
+             f->next->name_long);
+      failures++;
+    }
+  }
+  return t;
+}
+
+// n positional arguments around a few flags
+double positionals(int n) {
+  char **argv = malloc((n + 1) * sizeof(char *));
+  argv[0] = "complexity";
+  for (int i = 1; i < n; ++i) {
+    argv[i] = i % 1000 == 0 ? "-v" : "input";
+  }
+  argv[n] = NULL;
+
+  bool verbose = false;
+  flgset_t fset = {0};
+  flgset_bool(&fset, &verbose, 'v', "verbose", "Verbose");
+
+  double start = now();
+  flgset_parse(&fset, n, argv);
+  double t = now() - start;
+  if (fset.narg != n - (n - 1) / 1000) {
+    printf("  positionals: %d instead of %d\n", fset.narg,
+           n - (n - 1) / 1000);
+    failures++;
+  }
+  free(argv);
+  return t;
+}
+
+// n occurrences of an int array flag with its items in the arena
+double array_occurrences(int n) {
+  char **argv = malloc((2 * n + 2) * sizeof(char *));
+  argv[0] = "complexity";
+  for (int i = 0; i < n; ++i) {
+    argv[1 + 2 * i] = "--ports";
+    argv[2 + 2 * i] = "80,443";
+  }
+  argv[2 * n + 1] = NULL;
+
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  cflg_array_t ports = {.arena = &fset.arena, .cap = 2u * n};
+  flgset_int_array(&fset, &ports, 'p', "ports", "<LIST>", "Ports");
+
+  double start = now();
+  flgset_parse(&fset, 2 * n + 1, argv);
+  double t = now() - start;
+  if (ports.count != 2u * n) {
+    printf("  array occurrences: %u values instead of %d\n", ports.count,
+           2 * n);
+    failures++;
+  }
+  free(argv);
+  return t;
+}
+
+// n huge ranges given to an arena-backed array flag whose cap is 0, which keeps
+// only CFLG_ARRAY_MAX values and counts the rest
+double array_ranges(int n) {
+  char **argv = malloc((n + 2) * sizeof(char *));
+  argv[0] = "complexity";
+  for (int i = 1; i <= n; ++i) {
+    argv[i] = "--xs=0-4000000000";
+  }
+  argv[n + 1] = NULL;
+
+  flgset_t fset = {0};
+  fset.arena.grow = arena_grow;
+  cflg_array_t xs = {.arena = &fset.arena};
+  flgset_int64_array(&fset, &xs, 'x', "xs", "<LIST>", "Values");
+
+  double start = now();
+  flgset_parse(&fset, n + 1, argv);
+  double t = now() - start;
+  if (xs.count != CFLG_ARRAY_MAX || xs.alloc > CFLG_ARRAY_MAX || !xs.overflow) {
+    printf("  array ranges: %u values in %u, overflow %d\n", xs.count, xs.alloc,
+           xs.overflow);
+    failures++;
+  }
+  free(argv);
+  return t;
+}
+
+int main(void) {
+  a_names = malloc((1 << 16) * sizeof(char *));
+  f_names = malloc((1 << 17) * sizeof(char *));
+  for (int i = 0; i < 1 << 16; ++i) {
+    a_names[i] = flag_name("a", i);
+  }
+  for (int i = 0; i < 1 << 17; ++i) {
+    f_names[i] = flag_name("flag-", i);
+  }
+  // the ambiguity reports are only timed
+  if (freopen("/dev/null", "w", stderr) == NULL) {
+    perror("/dev/null");
+    return 1;
+  }
+
+  printf("--- Complexity Checks (fastest of %d runs) ---\n\n", RUNS);
+  check("short cluster", short_cluster, 512 * 1024, LINEAR_BOUND);
+  check("ambiguous prefixes (flags)", ambiguous_prefixes, 4000, FLAT_BOUND);
+  check("ambiguous prefixes (args)", ambiguous_args, 20000, LINEAR_BOUND);
+  check("reverse order sort", reverse_sort, 20000, LINEAR_BOUND);
+  check("positionals", positionals, 1000000, LINEAR_BOUND);
+  check("array occurrences", array_occurrences, 20000, LINEAR_BOUND);
+  check("array ranges", array_ranges, 20000, LINEAR_BOUND);
+
+  printf("\n%s\n", failures ? "FAILED" : "passed");
+  return failures != 0;
+}
@@ -0,0 +1,185 @@
+// fuzz_parse - libFuzzer and AFL harness for cflg_flgset_parse.
+//
+// The input is split at NUL bytes into argv[1..], after a fixed argv[0]; its
+// first byte picks the matching policy and POSIX mode. One flag set of every
+// kind of flag (with aliases and constraints) then goes through
+// cflg_flgset_parse, cflg_flgset_parse_const, cflg_next and cflg_flgset_peek,
+// and the input as one string through cflg_flgset_parse_line.
+//
+// cflg_flgset_parse reports errors and calls exit() in hosted builds, which
+// would end the fuzzer at the first bad option, so the library is built with
+// CFLG_FREESTANDING here: parsing returns CFLG_PARSE_FAILED or CFLG_PARSE_HELP
+// instead, and the messages are still formatted, then dropped by CFLG_WRITE.
+// That also puts the built-in number parsers under test.
+//
+// libFuzzer:  clang -g -O1 -fsanitize=fuzzer,address,undefined -o fuzz_parse
+//               tests/fuzz_parse.c
+//             ./fuzz_parse -max_len=4096
+// AFL:        afl-clang-fast -g -DFUZZ_MAIN -o fuzz_parse tests/fuzz_parse.c
+//             afl-fuzz -i seeds -o findings -- ./fuzz_parse
+// Replay:     cc -g -fsanitize=address,undefined -DFUZZ_MAIN -o fuzz_parse
+//               tests/fuzz_parse.c && ./fuzz_parse < crash
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CFLG_FREESTANDING
+#define CFLG_WRITE(out, buf, len) ((void)(out), (void)(buf), (void)(len))
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+// arguments taken from one input, the rest is ignored
+#define MAX_ARGS 256
+
+// --- Flag Set ---
+
+// variables bound to the flags
+typedef struct {
+  bool verbose, quiet, dry_run;
+  int count, mode;
+  int64_t offset;
+  uint64_t size;
+  double ratio;
+  float scale;
+  char *output, *name;
+  int ports[8];
+  cflg_array_t port_list, ratios;
+  cflg_map_entry_t env_slots[16];
+  cflg_map_t env;
+} values_t;
+
+// registers the same flags in every flag set; a macro without a block of its
+// own, as the flags are compound literals which must live in the caller's one
+#define DEFINE_FLAGS(fs, v, policy)                                            \
+  (fs)->match = (policy) & 3;                                                  \
+  (fs)->posix = ((policy) & 4) != 0;                                           \
+  (v)->port_list = (cflg_array_t){.items = (v)->ports, .cap = 8};              \
+  (v)->ratios = (cflg_array_t){.arena = &(fs)->arena, .cap = 64};              \
+  (v)->env = (cflg_map_t){.slots = (v)->env_slots, .mask = 15};                \
+  cflg_flg_t *verbose_flg = flg_alias(                                         \
+      flgset_bool((fs), &(v)->verbose, 'v', "verbose", "Verbose"), 'V',        \
+      "Talk_A-Lot");                                                           \
+  cflg_flg_t *quiet_flg =                                                      \
+      flgset_bool((fs), &(v)->quiet, 'q', "quiet", "Quiet");                   \
+  cflg_flg_t *dry_flg =                                                        \
+      flgset_bool((fs), &(v)->dry_run, 0, "dry-run", "Dry run");               \
+  cflg_flg_t *count_flg =                                                      \
+      flgset_int((fs), &(v)->count, 'c', "count", "<N>", "Count");             \
+  flgset_int64((fs), &(v)->offset, 0, "offset", "<N>", "Offset");              \
+  flgset_uint64((fs), &(v)->size, 's', "size", "<N>", "Size");                 \
+  flgset_double((fs), &(v)->ratio, 'r', "ratio", "<X>", "Ratio");              \
+  flgset_float((fs), &(v)->scale, 0, "scale", "<X>", "Scale");                 \
+  flgset_string((fs), &(v)->output, 'o', "output", "<FILE>", "Output");        \
+  flgset_string((fs), &(v)->name, 0, "name", NULL, "Name");                    \
+  flgset_enum((fs), &(v)->mode, 'm', "mode", NULL, "Mode", "fast", "fair",     \
+              "slow");                                                         \
+  flgset_int_array((fs), &(v)->port_list, 'p', "ports", NULL, "Ports");        \
+  flgset_double_array((fs), &(v)->ratios, 0, "ratios", NULL, "Ratios");        \
+  flgset_map((fs), &(v)->env, 'e', "env", NULL, "Environment");                \
+  flgset_constrain((fs), CFLG_AT_MOST_ONE, verbose_flg, quiet_flg);            \
+  flgset_requires((fs), dry_flg, count_flg)
+
+// a fresh flag set with its own arena
+#define NEW_FLGSET(fs, mem)                                                    \
+  flgset_t fs = {0};                                                           \
+  fs.arena = (cflg_arena_t){.base = (unsigned char *)(mem), .cap = sizeof(mem)}
+
+// --- Harness ---
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  static char text[65536], line[65536];
+  static char *args[MAX_ARGS + 1], *argv[MAX_ARGS + 1];
+  static int positionals[MAX_ARGS + 1];
+  static uint64_t mem[4096];
+
+  if (size == 0 || size >= sizeof(text)) {
+    return 0;
+  }
+  uint8_t policy = data[0];
+  memcpy(text, data + 1, size - 1);
+  text[size - 1] = '\0';
+
+  // argv[0] is fixed, the input holds NUL separated arguments
+  int argc = 0;
+  args[argc++] = "fuzz";
+  for (char *p = text; p < text + size - 1 && argc < MAX_ARGS;
+       p += strlen(p) + 1) {
+    args[argc++] = p;
+  }
+  args[argc] = NULL;
+
+  // cflg_flgset_parse rearranges argv
+  {
+    NEW_FLGSET(fs, mem);
+    values_t v = {0};
+    DEFINE_FLAGS(&fs, &v, policy);
+    memcpy(argv, args, sizeof(args));
+    int res = cflg_flgset_parse(&fs, argc, argv);
+    if (res >= 0) {
+      for (int i = 0; i < fs.narg; ++i) {
+        (void)strlen(cflg_flgset_arg(&fs, i));
+      }
+      (void)cflg_map_get(&v.env, "PATH");
+    }
+  }
+
+  // argv stays as it is, positionals are recorded
+  {
+    NEW_FLGSET(fs, mem);
+    values_t v = {0};
+    DEFINE_FLAGS(&fs, &v, policy);
+    if (cflg_flgset_parse_const(&fs, argc, args, positionals) >= 0) {
+      for (int i = 0; i < fs.narg; ++i) {
+        (void)strlen(cflg_flgset_arg(&fs, i));
+      }
+    }
+  }
+
+  // pull parsing, errors don't stop it
+  {
+    NEW_FLGSET(fs, mem);
+    values_t v = {0};
+    DEFINE_FLAGS(&fs, &v, policy);
+    cflg_iter_t it;
+    cflg_event_t ev;
+    cflg_iter_init(&it, &fs, argc, args);
+    while (cflg_next(&it, &ev)) {
+      if (ev.kind == CFLG_EVENT_ERROR) {
+        cflg_iter_print_err(&it, &ev);
+      }
+    }
+  }
+
+  // a few flags ahead of the others
+  {
+    NEW_FLGSET(fs, mem);
+    char *output = NULL;
+    int count = 0;
+    fs.match = policy & 3;
+    flgset_string(&fs, &output, 'o', "output", "<FILE>", "Output");
+    flgset_int(&fs, &count, 'c', "count", "<N>", "Count");
+    (void)cflg_flgset_peek(&fs, argc, args);
+  }
+
+  // the whole input as one shell-quoted command, up to its first NUL
+  {
+    NEW_FLGSET(fs, mem);
+    values_t v = {0};
+    DEFINE_FLAGS(&fs, &v, policy);
+    memcpy(line, text, size);
+    (void)cflg_flgset_parse_line(&fs, line, argv, MAX_ARGS + 1);
+  }
+  return 0;
+}
+
+#ifdef FUZZ_MAIN
+// reads one input from stdin, for AFL and for replaying crashes
+int main(void) {
+  static uint8_t buf[65536];
+  size_t size = fread(buf, 1, sizeof(buf), stdin);
+  return LLVMFuzzerTestOneInput(buf, size);
+}
+#endif
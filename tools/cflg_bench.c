@@ -0,0 +1,338 @@
+// cflg_bench - measures process startup of programs built with cflg.
+//
+// Microbenchmarks of cflg_flgset_parse miss most of what a short-lived CLI
+// pays for its flags: loading the binary, the stack taken by the compound
+// literals in main and the page faults of a large flag table. cflg_bench
+// builds examples/docker.c, wget.c and ping.c plus generated programs with
+// 1000 and 10000 flags, runs each of them many times with a representative
+// command line and reports the distribution of the time from spawning a
+// process until it has exited, and the peak resident set size.
+//
+// Usage: cflg_bench [-n RUNS] [-c CC] [-w DIR] [-r REPO] [-s FILE]
+//                   [-b FILE] [-x PERCENT]
+//
+// Results can be saved with -s and compared with a later run with -b, which
+// exits with 1 if the median of a program got more than PERCENT (default 10)
+// slower, e.g. before and after a change to cflg.h:
+//
+//   ./cflg_bench -s before.txt
+//   ... edit cflg.h ...
+//   ./cflg_bench -b before.txt
+//
+// Linux, as the peak RSS comes from wait4. Times include posix_spawn, so
+// compare runs on the same machine only. Compiling the 10000 flag program
+// takes a few minutes with -O2, its main is one huge function.
+//
+// Build: cc -O2 -o cflg_bench tools/cflg_bench.c
+
+#define _GNU_SOURCE // wait4
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+extern char **environ;
+
+// --- Targets ---
+
+// a program to measure and the command line it runs with
+typedef struct {
+  const char *name;   // label in the report
+  const char *source; // example under REPO/examples, NULL if generated
+  int nflags;         // number of generated flags
+  const char *args;   // space separated arguments after argv[0]
+} target_t;
+
+static target_t targets[] = {
+    {"docker", "docker.c", 0,
+     "-dit --rm --name web -e A=1 -e B=2 --memory=512m --cpuset-cpus=0-3 "
+     "--restart=always image cmd"},
+    {"wget", "wget.c", 0, "-q -O out --limit-rate=2m http://example.com/"},
+    {"ping", "ping.c", 0, "-c3 -W 2 --ttl=3 example.com"},
+    {"gen-1k", NULL, 1000, NULL},
+    {"gen-10k", NULL, 10000, NULL},
+};
+
+#define NTARGETS (sizeof(targets) / sizeof(targets[0]))
+
+// results of a target
+typedef struct {
+  double min, p50, p90, p99, max, mean; // microseconds
+  long rss;                             // peak resident set size, KiB
+} stats_t;
+
+char *format(const char *fmt, const char *a, const char *b) {
+  size_t size = strlen(fmt) + strlen(a) + strlen(b) + 1;
+  char *s = malloc(size);
+  snprintf(s, size, fmt, a, b);
+  return s;
+}
+
+// --- Generated Programs ---
+
+// Writes a program registering nflags flags with the macros in main, like a
+// hand-written CLI would, and sets its command line: every 64th flag is given
+// (ints with a value, bools alone, strings with '='), then a few positionals.
+bool generate(const char *path, target_t *t) {
+  FILE *out = fopen(path, "w");
+  if (out == NULL) {
+    perror(path);
+    return false;
+  }
+  fprintf(out, "#include <stdlib.h>\n\n"
+               "#define CFLG_IMPLEMENTATION\n"
+               "#include \"cflg.h\"\n\n"
+               "static int ints[%d];\n"
+               "static bool bools[%d];\n"
+               "static char *strings[%d];\n\n"
+               "int main(int argc, char *argv[]) {\n"
+               "  flgset_t fset = {0};\n",
+          t->nflags, t->nflags, t->nflags);
+  for (int i = 0; i < t->nflags; ++i) {
+    switch (i % 3) {
+    case 0:
+      fprintf(out,
+              "  flgset_int(&fset, &ints[%d], 0, \"option-%d\", \"<NUM>\", "
+              "\"Generated int option %d\");\n",
+              i, i, i);
+      break;
+    case 1:
+      fprintf(out,
+              "  flgset_bool(&fset, &bools[%d], 0, \"option-%d\", "
+              "\"Generated bool option %d\");\n",
+              i, i, i);
+      break;
+    case 2:
+      fprintf(out,
+              "  flgset_string(&fset, &strings[%d], 0, \"option-%d\", "
+              "\"<STR>\", \"Generated string option %d\");\n",
+              i, i, i);
+      break;
+    }
+  }
+  fprintf(out, "  size_t size = cflg_flgset_arena_size(&fset);\n"
+               "  fset.arena = (cflg_arena_t){.base = malloc(size), .cap = "
+               "size};\n"
+               "  flgset_parse(&fset, argc, argv);\n"
+               "  return fset.narg == 0;\n"
+               "}\n");
+  fclose(out);
+
+  static char args[2][4096];
+  char *a = args[t->nflags > 1000];
+  size_t len = 0;
+  for (int i = 0; i < t->nflags; i += 64) {
+    const char *fmt = i % 3 == 0   ? "--option-%d 42 "
+                      : i % 3 == 1 ? "--option-%d "
+                                   : "--option-%d=value ";
+    len += snprintf(a + len, sizeof(args[0]) - len, fmt, i);
+  }
+  snprintf(a + len, sizeof(args[0]) - len, "in-1 in-2 out");
+  t->args = a;
+  return true;
+}
+
+// --- Measurement ---
+
+// splits a copy of args at spaces into a NULL terminated argv
+char **make_argv(const char *prog, const char *args) {
+  char *s = strdup(args);
+  char **argv = malloc((strlen(args) / 2 + 3) * sizeof(char *));
+  int n = 0;
+  argv[n++] = (char *)prog;
+  for (char *tok = strtok(s, " "); tok; tok = strtok(NULL, " ")) {
+    argv[n++] = tok;
+  }
+  argv[n] = NULL;
+  return argv;
+}
+
+double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// runs the program once with its output discarded, returns the microseconds
+// from spawning it until wait4 returned, or -1 if it failed
+double run_once(char **argv, long *rss) {
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+  double start = now_us();
+  pid_t pid;
+  int res = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (res != 0) {
+    return -1;
+  }
+  int status;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) < 0) {
+    return -1;
+  }
+  double end = now_us();
+
+  if (usage.ru_maxrss > *rss) {
+    *rss = usage.ru_maxrss;
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? end - start : -1;
+}
+
+int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+bool measure(const char *bin, const char *args, int runs, stats_t *st) {
+  char **argv = make_argv(bin, args);
+  double *lat = malloc(runs * sizeof(double));
+  *st = (stats_t){0};
+
+  // the first run warms the page cache and checks the command line is valid
+  if (run_once(argv, &st->rss) < 0) {
+    fprintf(stderr, "cflg_bench: '%s %s' failed\n", bin, args);
+    return false;
+  }
+  st->rss = 0;
+  double sum = 0;
+  for (int i = 0; i < runs; ++i) {
+    lat[i] = run_once(argv, &st->rss);
+    if (lat[i] < 0) {
+      fprintf(stderr, "cflg_bench: '%s' failed on run %d\n", bin, i + 1);
+      return false;
+    }
+    sum += lat[i];
+  }
+  qsort(lat, runs, sizeof(double), cmp_double);
+  st->min = lat[0];
+  st->p50 = lat[runs / 2];
+  st->p90 = lat[(int)(runs * 0.9)];
+  st->p99 = lat[(int)(runs * 0.99)];
+  st->max = lat[runs - 1];
+  st->mean = sum / runs;
+  free(lat);
+  return true;
+}
+
+// --- Baselines ---
+
+// returns the median saved for name in a file written with -s, or -1
+double baseline(const char *path, const char *name) {
+  FILE *in = fopen(path, "r");
+  if (in == NULL) {
+    return -1;
+  }
+  char label[64];
+  double p50, res = -1;
+  while (fscanf(in, "%63s %lf", label, &p50) == 2) {
+    if (!strcmp(label, name)) {
+      res = p50;
+    }
+  }
+  fclose(in);
+  return res;
+}
+
+int main(int argc, char *argv[]) {
+  // --- Variable Definitions ---
+  int runs = 2000;
+  char *cc = "cc -O2";
+  char *work = "/tmp/cflg_bench";
+  char *repo = ".";
+  char *save = NULL;
+  char *compare = NULL;
+  double tolerance = 10;
+
+  // --- Flag Set Initialization ---
+  flgset_t fset = {0};
+  flgset_int(&fset, &runs, 'n', "runs", "<NUM>",
+             "Runs per program (default: 2000).");
+  flgset_string(&fset, &cc, 'c', "cc", "<CMD>",
+                "Compiler command (default: cc -O2).");
+  flgset_string(&fset, &work, 'w', "work-dir", "<DIR>",
+                "Directory for sources and binaries (default: /tmp/cflg_bench).");
+  flgset_string(&fset, &repo, 'r', "repo", "<DIR>",
+                "Root of the cflg repository (default: .).");
+  flgset_string(&fset, &save, 's', "save", "<FILE>",
+                "Save the medians to <FILE>.");
+  flgset_string(&fset, &compare, 'b', "baseline", "<FILE>",
+                "Compare the medians with those saved in <FILE>.");
+  flgset_double(&fset, &tolerance, 'x', "tolerance", "<PERCENT>",
+                "Slowdown reported as a regression (default: 10).");
+  flgset_parse(&fset, argc, argv);
+
+  if (runs < 1) {
+    fprintf(stderr, "%s: --runs must be positive\n", fset.prog_name);
+    return 1;
+  }
+  mkdir(work, 0755);
+
+  // --- Building ---
+  char *bins[NTARGETS];
+  for (size_t i = 0; i < NTARGETS; ++i) {
+    target_t *t = &targets[i];
+    char *src;
+    if (t->source) {
+      src = format("%s/examples/%s", repo, t->source);
+    } else {
+      src = format("%s/%s.c", work, t->name);
+      if (!generate(src, t)) {
+        return 1;
+      }
+    }
+    bins[i] = format("%s/%s", work, t->name);
+
+    char cmd[4096];
+    snprintf(cmd, sizeof(cmd), "%s -I%s -o %s %s", cc, repo, bins[i], src);
+    printf("building %s\n", t->name);
+    fflush(stdout);
+    if (system(cmd) != 0) {
+      fprintf(stderr, "%s: failed to build %s\n", fset.prog_name, src);
+      return 1;
+    }
+    free(src);
+  }
+
+  // --- Print Results ---
+  printf("\n--- Startup Latency (%d runs, microseconds) ---\n\n", runs);
+  printf("  %-10s %9s %9s %9s %9s %9s %9s %10s\n", "Program", "min", "p50",
+         "p90", "p99", "max", "mean", "RSS (KiB)");
+
+  FILE *saved = save ? fopen(save, "w") : NULL;
+  bool regressed = false;
+  for (size_t i = 0; i < NTARGETS; ++i) {
+    stats_t st;
+    if (!measure(bins[i], targets[i].args, runs, &st)) {
+      return 1;
+    }
+    printf("  %-10s %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %10ld", targets[i].name,
+           st.min, st.p50, st.p90, st.p99, st.max, st.mean, st.rss);
+    double base = compare ? baseline(compare, targets[i].name) : -1;
+    if (base > 0) {
+      double change = (st.p50 - base) / base * 100;
+      regressed = regressed || change > tolerance;
+      printf("  %+6.1f%%%s", change, change > tolerance ? " REGRESSION" : "");
+    }
+    printf("\n");
+    if (saved) {
+      fprintf(saved, "%s %.1f\n", targets[i].name, st.p50);
+    }
+  }
+  if (saved) {
+    fclose(saved);
+  }
+  return regressed;
+}
@@ -0,0 +1,674 @@
+// cflg_gen - compiles a flag definition file into C source for cflg.
+//
+// The output holds a static flag table, a minimal perfect hash over the long
+// names, the short name table and the sorted, fully formatted --help text as
+// one string literal, so a program built with it does no registration, index
+// building or sorting at startup and prints its help with a single write.
+//
+// Usage: cflg_gen [-o FILE] [-p PREFIX] [-n PROGRAM] DEFINITIONS
+//
+// A definition file has one entry per line, '#' starts a comment and '-'
+// stands for an absent field:
+//
+//   program  mytool
+//   # type   short  long      arg        usage
+//   bool     v      verbose   -          Verbose output
+//   int      c      count     <NUM>      Stop after <NUM> replies
+//   string   o      output    <FILE>     Write to <FILE>
+//   enum     -      restart   <POLICY>   no,always,on-failure Restart policy
+//   alias    verbose V  talkative
+//
+// Types are bool, int, uint, int64, uint64, float, double, string and enum,
+// whose choices come before the usage, separated by commas. An alias line
+// names a flag by its long (or short) name, followed by the new short and
+// long names. Names are checked for conflicts just like cflg_flgset_parse
+// does, so a generated file never fails at runtime.
+//
+// The output defines, with PREFIX "cli" (the default):
+//
+//   cli_t cli;                // values of the flags, fields are named after
+//                             // the long names ('-' becomes '_')
+//   cflg_flgset_t cli_flgset; // ready to be passed to cflg_flgset_parse
+//
+// and is meant to be included once, after cflg.h:
+//
+//   #define CFLG_IMPLEMENTATION
+//   #include "cflg.h"
+//   #include "cli_flags.h"
+//
+//   int main(int argc, char *argv[]) {
+//     cflg_flgset_parse(&cli_flgset, argc, argv);
+//     if (cli.verbose) ...
+//   }
+//
+// Build: cc -o cflg_gen tools/cflg_gen.c
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CFLG_IMPLEMENTATION
+#include "../cflg.h"
+
+// --- Arena ---
+
+// Grows the definitions' arena with blocks from malloc, they live until exit.
+bool arena_grow(cflg_arena_t *arena, size_t size) {
+  size_t cap = size > 64 * 1024 ? size : 64 * 1024;
+  unsigned char *block = malloc(cap);
+  if (block == NULL) {
+    return false;
+  }
+  arena->base = block;
+  arena->cap = cap;
+  return true;
+}
+
+// --- Definitions ---
+
+// a value type of the definition file
+typedef struct {
+  const char *name;     // keyword in definition files
+  const char *ctype;    // type of the generated field
+  const char *parser;   // name of the cflg parser
+  cflg_parser_t parse;  // the parser itself, identifies the type of a flag
+} type_t;
+
+static const type_t types[] = {
+    {"bool", "bool", "cflg_parse_bool", cflg_parse_bool},
+    {"int", "int", "cflg_parse_int", cflg_parse_int},
+    {"uint", "unsigned int", "cflg_parse_uint", cflg_parse_uint},
+    {"int64", "int64_t", "cflg_parse_int64", cflg_parse_int64},
+    {"uint64", "uint64_t", "cflg_parse_uint64", cflg_parse_uint64},
+    {"float", "float", "cflg_parse_float", cflg_parse_float},
+    {"double", "double", "cflg_parse_double", cflg_parse_double},
+    {"string", "char *", "cflg_parse_string", cflg_parse_string},
+    {"enum", "int", "cflg_parse_enum", cflg_parse_enum},
+};
+
+#define NTYPES (sizeof(types) / sizeof(types[0]))
+
+const char *path = NULL; // definition file, for error messages
+int lineno = 0;          // current line of the definition file
+
+void fail(const char *msg, const char *arg) {
+  fprintf(stderr, "%s:%d: %s%s\n", path, lineno, msg, arg);
+  exit(1);
+}
+
+const type_t *find_type(cflg_parser_t parse) {
+  for (size_t i = 0; i < NTYPES; ++i) {
+    if (types[i].parse == parse) {
+      return &types[i];
+    }
+  }
+  return NULL;
+}
+
+// returns the next whitespace separated field of *line and skips it,
+// NULL if there are no more fields
+char *next_field(char **line) {
+  char *s = *line;
+  while (isspace((unsigned char)*s)) {
+    s++;
+  }
+  if (*s == '\0') {
+    return NULL;
+  }
+  char *start = s;
+  while (*s && !isspace((unsigned char)*s)) {
+    s++;
+  }
+  if (*s) {
+    *s++ = '\0';
+  }
+  *line = s;
+  return start;
+}
+
+// copies a field into the arena, "-" means absent
+char *copy_field(cflg_arena_t *arena, const char *field) {
+  if (field == NULL || !strcmp(field, "-")) {
+    return NULL;
+  }
+  char *s = cflg_arena_strdup(arena, field);
+  if (s == NULL) {
+    fail("out of memory", "");
+  }
+  return s;
+}
+
+char short_name(const char *field) {
+  if (field == NULL || !strcmp(field, "-")) {
+    return 0;
+  }
+  if (strlen(field) != 1) {
+    fail("short names are a single character: ", field);
+  }
+  return field[0];
+}
+
+// splits comma separated choices into a NULL terminated list in the arena
+const char *const *split_choices(cflg_arena_t *arena, char *list) {
+  size_t n = 1;
+  for (char *c = list; *c; ++c) {
+    n += *c == ',';
+  }
+  const char **choices = cflg_arena_alloc(arena, (n + 1) * sizeof(char *));
+  if (choices == NULL) {
+    fail("out of memory", "");
+  }
+  n = 0;
+  for (char *c = list;; ++c) {
+    char *end = strchr(c, ',');
+    if (end) {
+      *end = '\0';
+    }
+    if (*c == '\0') {
+      fail("empty choice in ", list);
+    }
+    choices[n++] = copy_field(arena, c);
+    if (end == NULL) {
+      break;
+    }
+    c = end;
+  }
+  choices[n] = NULL;
+  return choices;
+}
+
+cflg_flg_t *find_flag(flgset_t *defs, const char *name) {
+  CFLG_FOREACH(f, defs->flgs) {
+    if ((f->name_long && !strcmp(f->name_long, name)) ||
+        (f->name && !name[1] && f->name == name[0])) {
+      return f;
+    }
+  }
+  return NULL;
+}
+
+// reads the definition file into defs, returns the program name if given
+char *read_definitions(FILE *in, flgset_t *defs) {
+  char buf[4096];
+  char *program = NULL;
+
+  while (fgets(buf, sizeof(buf), in)) {
+    lineno++;
+    char *hash = strchr(buf, '#');
+    if (hash) {
+      *hash = '\0';
+    }
+    char *line = buf;
+    char *kind = next_field(&line);
+    if (kind == NULL) {
+      continue;
+    }
+
+    if (!strcmp(kind, "program")) {
+      program = copy_field(&defs->arena, next_field(&line));
+      continue;
+    }
+
+    if (!strcmp(kind, "alias")) {
+      char *target = next_field(&line);
+      char *name = next_field(&line);
+      char *name_long = next_field(&line);
+      if (name_long == NULL) {
+        fail("alias needs a flag, a short and a long name", "");
+      }
+      cflg_flg_t *f = find_flag(defs, target);
+      if (f == NULL) {
+        fail("alias of an undefined flag: ", target);
+      }
+      if (!cflg_flgset_add_alias(defs, f, short_name(name),
+                                 copy_field(&defs->arena, name_long))) {
+        fail("out of memory", "");
+      }
+      continue;
+    }
+
+    const type_t *type = NULL;
+    for (size_t i = 0; i < NTYPES; ++i) {
+      if (!strcmp(types[i].name, kind)) {
+        type = &types[i];
+      }
+    }
+    if (type == NULL) {
+      fail("unknown type: ", kind);
+    }
+
+    char *name = next_field(&line);
+    char *name_long = next_field(&line);
+    char *arg_name = next_field(&line);
+    if (arg_name == NULL) {
+      fail("expected short name, long name and argument name", "");
+    }
+    if (short_name(name) == 0 && !strcmp(name_long, "-")) {
+      fail("flag needs a short or a long name", "");
+    }
+    if ((type->parse == cflg_parse_bool) != !strcmp(arg_name, "-")) {
+      fail("bool flags, and only them, have no argument name: ", arg_name);
+    }
+
+    void *dest = NULL;
+    if (type->parse == cflg_parse_enum) {
+      cflg_enum_t *e = cflg_arena_alloc(&defs->arena, sizeof(cflg_enum_t));
+      char *list = next_field(&line);
+      if (e == NULL || list == NULL) {
+        fail("enum flag needs its choices", "");
+      }
+      *e = (cflg_enum_t){.choices = split_choices(&defs->arena, list)};
+      dest = e;
+    }
+
+    // the rest of the line is the usage
+    while (isspace((unsigned char)*line)) {
+      line++;
+    }
+    size_t len = strlen(line);
+    while (len > 0 && isspace((unsigned char)line[len - 1])) {
+      line[--len] = '\0';
+    }
+
+    if (cflg_flgset_add(defs, type->parse, dest, short_name(name),
+                        copy_field(&defs->arena, name_long),
+                        copy_field(&defs->arena, arg_name),
+                        copy_field(&defs->arena, line)) == NULL) {
+      fail("out of memory", "");
+    }
+  }
+  return program;
+}
+
+// --- Minimal Perfect Hash ---
+
+// Hash and displace: names are split into n/4 + 1 buckets by their unseeded
+// hash, then, largest bucket first, a seed is searched which sends every name
+// of the bucket to a free slot. Each of the n slots ends up with one name.
+uint32_t *perfect_hash(cflg_index_t *idx, uint32_t *slots, uint32_t *ndisp) {
+  uint32_t n = idx->nnames;
+  uint32_t nb = n / 4 + 1;
+  uint32_t *disp = calloc(nb, sizeof(uint32_t));
+  uint32_t *start = calloc(nb + 1, sizeof(uint32_t));
+  uint32_t *members = calloc(n, sizeof(uint32_t));
+  uint32_t *order = calloc(nb, sizeof(uint32_t));
+  uint32_t *trial = calloc(n, sizeof(uint32_t));
+  if (!disp || !start || !members || !order || !trial) {
+    fail("out of memory", "");
+  }
+
+  // group the names by bucket
+  for (uint32_t i = 0; i < n; ++i) {
+    start[cflg_hash(idx->names[i].name, idx->names[i].len, 0) % nb + 1]++;
+  }
+  uint32_t max = 0;
+  for (uint32_t b = 0; b < nb; ++b) {
+    max = start[b + 1] > max ? start[b + 1] : max;
+    start[b + 1] += start[b];
+  }
+  uint32_t *fill = trial; // names placed per bucket, trial is free until below
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t b = cflg_hash(idx->names[i].name, idx->names[i].len, 0) % nb;
+    members[start[b] + fill[b]++] = i;
+  }
+
+  // bucket sort by size, largest first
+  uint32_t k = 0;
+  for (uint32_t size = max; size > 0; --size) {
+    for (uint32_t b = 0; b < nb; ++b) {
+      if (start[b + 1] - start[b] == size) {
+        order[k++] = b;
+      }
+    }
+  }
+
+  memset(slots, 0, n * sizeof(uint32_t));
+  for (uint32_t o = 0; o < k; ++o) {
+    uint32_t b = order[o];
+    uint32_t size = start[b + 1] - start[b];
+    for (uint32_t d = 0;; ++d) {
+      if (d == UINT32_MAX) {
+        fail("no perfect hash found", "");
+      }
+      uint32_t j;
+      for (j = 0; j < size; ++j) {
+        cflg_name_t *name = &idx->names[members[start[b] + j]];
+        trial[j] = cflg_hash(name->name, name->len, d) % n;
+        if (slots[trial[j]]) {
+          break;
+        }
+        // taken tentatively, released below if the bucket doesn't fit
+        slots[trial[j]] = members[start[b] + j] + 1;
+      }
+      if (j == size) {
+        disp[b] = d;
+        break;
+      }
+      while (j-- > 0) {
+        slots[trial[j]] = 0;
+      }
+    }
+  }
+
+  free(start);
+  free(members);
+  free(order);
+  free(trial);
+  *ndisp = nb;
+  return disp;
+}
+
+// --- Output ---
+
+// prints s as a C string literal, or NULL
+void emit_str(FILE *out, const char *s) {
+  if (s == NULL) {
+    fprintf(out, "NULL");
+    return;
+  }
+  fputc('"', out);
+  for (; *s; ++s) {
+    unsigned char c = *s;
+    if (c == '"' || c == '\\') {
+      fprintf(out, "\\%c", c);
+    } else if (c == '\n') {
+      fprintf(out, "\\n");
+    } else if (c < ' ' || c > '~') {
+      fprintf(out, "\\%03o", c);
+    } else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+static const char *keywords[] = {
+    "auto",     "break",  "case",     "char",   "const",    "continue", "default",  "do",
+    "double",   "else",   "enum",     "extern", "float",    "for",      "goto",     "if",
+    "inline",   "int",    "long",     "register", "restrict", "return", "short",    "signed",
+    "sizeof",   "static", "struct",   "switch", "typedef",  "union",    "unsigned", "void",
+    "volatile", "while",  "bool",     "true",   "false",    NULL};
+
+// prints c as a C character literal, or 0
+void emit_char(FILE *out, char c) {
+  if (c == '\'' || c == '\\') {
+    fprintf(out, "'\\%c'", c);
+  } else if (c > ' ' && c <= '~') {
+    fprintf(out, "'%c'", c);
+  } else {
+    fprintf(out, "%d", c);
+  }
+}
+
+// field of the values struct for f, named after its long name or "flag_<c>"
+void field_name(cflg_flg_t *f, char *buf, size_t size) {
+  if (CFLG_ISEMPTY(f->name_long)) {
+    if (isalnum((unsigned char)f->name)) {
+      snprintf(buf, size, "flag_%c", f->name);
+    } else {
+      snprintf(buf, size, "flag_%02x", (unsigned char)f->name);
+    }
+    return;
+  }
+  size_t n = 0;
+  if (isdigit((unsigned char)f->name_long[0])) {
+    buf[n++] = '_';
+  }
+  for (const char *c = f->name_long; *c && n + 1 < size; ++c) {
+    buf[n++] = isalnum((unsigned char)*c) ? *c : '_';
+  }
+  buf[n] = '\0';
+  for (const char **k = keywords; *k; ++k) {
+    if (!strcmp(buf, *k) && n + 1 < size) {
+      buf[n++] = '_';
+      buf[n] = '\0';
+    }
+  }
+}
+
+// reads back everything written to a temporary file
+char *slurp(FILE *tmp) {
+  long size = ftell(tmp);
+  char *s = malloc(size + 1);
+  if (s == NULL) {
+    fail("out of memory", "");
+  }
+  rewind(tmp);
+  s[fread(s, 1, size, tmp)] = '\0';
+  return s;
+}
+
+void emit(FILE *out, const char *p, cflg_index_t *idx, const char *help) {
+  uint32_t nflgs = idx->nflgs - 1; // without the help flag
+  char field[256];
+
+  fprintf(out, "// generated by cflg_gen from %s, do not edit\n\n", path);
+
+  // values, ids run against the definition order
+  fprintf(out, "typedef struct {\n");
+  for (uint32_t id = nflgs; id >= 1; --id) {
+    field_name(idx->flgs[id], field, sizeof(field));
+    const char *ctype = find_type(idx->flgs[id]->parser)->ctype;
+    fprintf(out, "    %s%s%s;\n", ctype, ctype[strlen(ctype) - 1] == '*' ? "" : " ", field);
+  }
+  fprintf(out, "} %s_t;\n\nstatic %s_t %s;\n\n", p, p, p);
+
+  // enums, their perfect hash tables are built here as well
+  for (uint32_t id = 1; id <= nflgs; ++id) {
+    cflg_flg_t *f = idx->flgs[id];
+    if (f->parser != cflg_parse_enum) {
+      continue;
+    }
+    cflg_enum_t *e = f->dest;
+    field_name(f, field, sizeof(field));
+    fprintf(out, "static const char *const %s_%s_choices[] = {", p, field);
+    for (uint32_t i = 0; i < e->nchoices; ++i) {
+      emit_str(out, e->choices[i]);
+      fprintf(out, ", ");
+    }
+    fprintf(out, "NULL};\n");
+    if (e->table) {
+      fprintf(out, "static uint16_t %s_%s_table[] = {", p, field);
+      for (uint32_t i = 0; i <= e->mask; ++i) {
+        fprintf(out, i ? ", %u" : "%u", e->table[i]);
+      }
+      fprintf(out, "};\n");
+    }
+    fprintf(out,
+            "static cflg_enum_t %s_%s_enum = {.dest = &%s.%s, .choices = %s_%s_choices, "
+            ".nchoices = %u, .seed = %u, .mask = %u, .table = ",
+            p, field, p, field, p, field, e->nchoices, e->seed, e->mask);
+    if (e->table) {
+      fprintf(out, "%s_%s_table};\n\n", p, field);
+    } else {
+      fprintf(out, "NULL};\n\n");
+    }
+  }
+
+  // flags, in id order, id 0 is reserved for the help flag
+  fprintf(out, "static cflg_flg_t %s_flgs[%u] = {\n", p, nflgs);
+  for (uint32_t id = 1; id <= nflgs; ++id) {
+    cflg_flg_t *f = idx->flgs[id];
+    field_name(f, field, sizeof(field));
+    fprintf(out, "    {.parser = %s, .dest = ", find_type(f->parser)->parser);
+    if (f->parser == cflg_parse_enum) {
+      fprintf(out, "&%s_%s_enum", p, field);
+    } else {
+      fprintf(out, "&%s.%s", p, field);
+    }
+    fprintf(out, ", .usage = ");
+    emit_str(out, f->usage);
+    fprintf(out, ", .arg_name = ");
+    emit_str(out, f->arg_name);
+    fprintf(out, ", .name_long = ");
+    emit_str(out, f->name_long);
+    fprintf(out, ", .name = ");
+    emit_char(out, f->name);
+    fprintf(out, ", .id = %u, .next = ", id);
+    if (id < nflgs) {
+      fprintf(out, "&%s_flgs[%u]},\n", p, id);
+    } else {
+      fprintf(out, "NULL},\n");
+    }
+  }
+  fprintf(out, "};\n\n");
+
+  // index
+  fprintf(out, "static cflg_flg_t *%s_index_flgs[%u] = {NULL", p, nflgs + 1);
+  for (uint32_t id = 1; id <= nflgs; ++id) {
+    fprintf(out, ", &%s_flgs[%u]", p, id - 1);
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "static cflg_name_t %s_names[%u] = {\n", p, idx->nnames);
+  for (uint32_t i = 0; i < idx->nnames; ++i) {
+    fprintf(out, "    {");
+    emit_str(out, idx->names[i].name);
+    fprintf(out, ", %u, %u},\n", idx->names[i].len, idx->names[i].id);
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "static uint32_t %s_runs[%u] = {", p, idx->nnames);
+  for (uint32_t i = 0; i < idx->nnames; ++i) {
+    fprintf(out, i ? ", %u" : "%u", idx->runs[i]);
+  }
+  fprintf(out, "};\n\n");
+
+  uint32_t ndisp;
+  uint32_t *slots = calloc(idx->nnames, sizeof(uint32_t));
+  if (slots == NULL) {
+    fail("out of memory", "");
+  }
+  uint32_t *disp = perfect_hash(idx, slots, &ndisp);
+  fprintf(out, "static const uint32_t %s_disp[%u] = {", p, ndisp);
+  for (uint32_t i = 0; i < ndisp; ++i) {
+    fprintf(out, i ? ", %u" : "%u", disp[i]);
+  }
+  fprintf(out, "};\n\n");
+  fprintf(out, "static uint32_t %s_slots[%u] = {", p, idx->nnames);
+  for (uint32_t i = 0; i < idx->nnames; ++i) {
+    fprintf(out, i ? ", %u" : "%u", slots[i]);
+  }
+  fprintf(out, "};\n\n");
+
+  fprintf(out, "static uint64_t %s_seen[%u];\n\n", p, (nflgs + 1 + 63) / 64);
+
+  fprintf(out, "static cflg_index_t %s_index = {\n", p);
+  fprintf(out, "    .flgs = %s_index_flgs,\n    .nflgs = %u,\n", p, nflgs + 1);
+  fprintf(out, "    .names = %s_names,\n    .runs = %s_runs,\n    .nnames = %u,\n", p, p, idx->nnames);
+  fprintf(out, "    .slots = %s_slots,\n    .shorts = {", p);
+  for (int c = 0, n = 0; c < 256; ++c) {
+    if (idx->shorts[c]) {
+      fprintf(out, n++ ? ", [%d] = %u" : "[%d] = %u", c, idx->shorts[c]);
+    }
+  }
+  fprintf(out, "},\n    .seen = %s_seen,\n", p);
+  fprintf(out, "    .disp = %s_disp,\n    .ndisp = %u,\n};\n\n", p, ndisp);
+
+  // help, one literal per line
+  fprintf(out, "static const char %s_help[] =", p);
+  for (const char *line = help; *line;) {
+    const char *end = strchr(line, '\n');
+    size_t len = end ? (size_t)(end - line + 1) : strlen(line);
+    char buf[4096];
+    while (len > 0) {
+      size_t chunk = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+      memcpy(buf, line, chunk);
+      buf[chunk] = '\0';
+      fprintf(out, "\n    ");
+      emit_str(out, buf);
+      line += chunk;
+      len -= chunk;
+    }
+  }
+  fprintf(out, ";\n\n");
+
+  fprintf(out, "static void %s_usage(cflg_flgset_t *fset) {\n", p);
+  fprintf(out, "    (void) fset;\n");
+  fprintf(out, "    fwrite(%s_help, 1, sizeof(%s_help) - 1, stdout);\n}\n\n", p, p);
+
+  fprintf(out, "static cflg_flgset_t %s_flgset = {.flgs = %s_flgs, .usage = %s_usage, .index = &%s_index};\n",
+          p, p, p, p);
+
+  free(slots);
+  free(disp);
+}
+
+int main(int argc, char *argv[]) {
+  // --- Variable Definitions ---
+  char *output = NULL;
+  char *prefix = "cli";
+  char *program = NULL;
+
+  // --- Flag Set Initialization ---
+  flgset_t fset = {0};
+  flgset_string(&fset, &output, 'o', "output", "<FILE>",
+                "Write the generated source to <FILE> (default: stdout).");
+  flgset_string(&fset, &prefix, 'p', "prefix", "<NAME>",
+                "Prefix of the generated names (default: cli).");
+  flgset_string(&fset, &program, 'n', "name", "<PROGRAM>",
+                "Program name shown in the help text.");
+  flgset_parse(&fset, argc, argv);
+
+  if (fset.narg != 2) {
+    fprintf(stderr, "Usage: %s [OPTION]... DEFINITIONS\n", fset.prog_name);
+    return 1;
+  }
+  path = fset.args[1];
+
+  // --- Definitions ---
+  FILE *in = fopen(path, "r");
+  if (in == NULL) {
+    perror(path);
+    return 1;
+  }
+  flgset_t defs = {.prog_name = path};
+  defs.arena.grow = arena_grow;
+  char *declared = read_definitions(in, &defs);
+  fclose(in);
+  if (defs.flgs == NULL) {
+    fail("no flags defined", "");
+  }
+  if (program == NULL) {
+    program = declared ? declared : prefix;
+  }
+
+  // the help flag is added last, exactly as cflg_flgset_parse does, so it gets id 0
+  // and gives way to flags using its names
+  cflg_flg_t *help = cflg_flgset_add(&defs, cflg_parse_bool, NULL, 'h', "help", NULL, "print this help");
+  if (help == NULL || cflg_flgset_index(&defs, help) != CFLG_OK) {
+    return 1;
+  }
+  if (cflg_flgset_find_short(&defs, help->name) != help) {
+    help->name = 0;
+  }
+
+  // --- Help ---
+  FILE *tmp = tmpfile();
+  if (tmp == NULL) {
+    perror("tmpfile");
+    return 1;
+  }
+  fprintf(tmp, "Usage: %s [OPTION]... [COMMAND]...\n\n", program);
+  cflg_sort_flags(&defs.flgs);
+  cflg_fprint_flags(tmp, defs.flgs);
+  char *text = slurp(tmp);
+  fclose(tmp);
+
+  // --- Output ---
+  FILE *out = output ? fopen(output, "w") : stdout;
+  if (out == NULL) {
+    perror(output);
+    return 1;
+  }
+  emit(out, prefix, defs.index, text);
+  if (fclose(out) != 0) {
+    perror(output ? output : "stdout");
+    return 1;
+  }
+  free(text);
+  return 0;
+}